@@ -4,6 +4,8 @@
  * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
  */
 
+#include <cstdlib>
+
 #include <sc-agents-common/utils/IteratorUtils.hpp>
 #include <sc-agents-common/utils/AgentUtils.hpp>
 #include <sc-agents-common/keynodes/coreKeynodes.hpp>
@@ -60,8 +62,8 @@ SC_AGENT_IMPLEMENTATION(DirectInferenceAgent)
 
   ScAddrVector answerElements;
 
-  InferenceConfig const & inferenceConfig{
-      GENERATE_UNIQUE_FORMULAS, REPLACEMENTS_FIRST, TREE_FULL, templateSearcherType};
+  InferenceConfig inferenceConfig{GENERATE_UNIQUE_FORMULAS, REPLACEMENTS_FIRST, TREE_FULL, templateSearcherType};
+  inferenceConfig.memoryBudget = getMemoryBudget(&m_memoryCtx, actionNode);
   ScAddrVector const & argumentVector = utils::IteratorUtils::getAllWithType(&m_memoryCtx, arguments, ScType::Node);
   ScAddr const & outputStructure = m_memoryCtx.CreateNode(ScType::NodeConstStruct);
   InferenceParams const & inferenceParams{
@@ -87,6 +89,25 @@ SC_AGENT_IMPLEMENTATION(DirectInferenceAgent)
   return SC_RESULT_OK;
 }
 
+size_t DirectInferenceAgent::getMemoryBudget(ScMemoryContext * context, ScAddr const & actionNode)
+{
+  ScAddr const rrel_5 = utils::IteratorUtils::getRoleRelation(context, 5);
+  ScAddr const memoryBudgetLink = utils::IteratorUtils::getAnyByOutRelation(context, actionNode, rrel_5);
+  if (!memoryBudgetLink.IsValid())
+    return 0;
+
+  std::string memoryBudgetContent;
+  context->GetLinkContent(memoryBudgetLink, memoryBudgetContent);
+  char * contentEnd = nullptr;
+  unsigned long long const memoryBudget = std::strtoull(memoryBudgetContent.c_str(), &contentEnd, 10);
+  if (memoryBudgetContent.empty() || *contentEnd != '\0' || memoryBudgetContent[0] == '-')
+  {
+    SC_LOG_WARNING("Memory budget `" << memoryBudgetContent << "` is not an amount of bytes, memory is not limited.");
+    return 0;
+  }
+  return memoryBudget;
+}
+
 bool DirectInferenceAgent::checkActionClass(ScMemoryContext * context, ScAddr const & actionNode)
 {
   return context->HelperCheckEdge(
@@ -20,6 +20,11 @@ class DirectInferenceAgent : public ScAgent
   SC_CLASS(Agent, Event(InferenceKeynodes::action_direct_inference, ScEvent::Type::AddOutputEdge))
   SC_GENERATED_BODY()
 
+public:
+  /// @returns amount of bytes from content of the link which is the fifth argument of the action, 0 for no limit if the
+  /// action has no such argument or its content is not a number
+  static size_t getMemoryBudget(ScMemoryContext * context, ScAddr const & actionNode);
+
 private:
   static bool checkActionClass(ScMemoryContext * context, ScAddr const & actionNode);
 };
@@ -0,0 +1,6 @@
+set(CMAKE_RUNTIME_OUTPUT_DIRECTORY ${SC_BIN_PATH}/inference-bench)
+
+file(GLOB_RECURSE BENCH_SOURCES "${CMAKE_CURRENT_LIST_DIR}/units/*.cpp" "${CMAKE_CURRENT_LIST_DIR}/units/*.hpp")
+
+add_executable(replacements-bench ${BENCH_SOURCES})
+target_link_libraries(replacements-bench inferenceModule benchmark)
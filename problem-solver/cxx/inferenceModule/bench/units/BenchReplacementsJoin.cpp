@@ -0,0 +1,216 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "utils/ReplacementsHashIndex.hpp"
+#include "utils/ReplacementsKernels.hpp"
+#include "utils/ReplacementsUtils.hpp"
+
+#include "ReplacementsGenerator.hpp"
+
+namespace inferenceBench
+{
+/**
+ * @brief Make replacements for variables {key, value} with `rowsAmount` rows and `keysAmount` distinct keys.
+ * Rows are clustered by key if `isClustered`, otherwise keys are shuffled
+ */
+inference::Replacements makeReplacements(
+    ScAddr const & keyVariable,
+    ScAddr const & valueVariable,
+    size_t rowsAmount,
+    size_t keysAmount,
+    bool isClustered,
+    size_t seed)
+{
+  std::vector<size_t> keys(rowsAmount);
+  for (size_t row = 0; row < rowsAmount; ++row)
+    keys[row] = row * keysAmount / rowsAmount;
+  if (!isClustered)
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64(seed));
+
+  inference::Replacements replacements(ScAddrVector{keyVariable, valueVariable});
+  replacements.reserve(rowsAmount);
+  for (size_t row = 0; row < rowsAmount; ++row)
+    replacements.addRow({makeAddr(keys[row]), makeAddr(1000000 + seed * rowsAmount + row)});
+  return replacements;
+}
+
+template <inference::Replacements (*Intersect)(inference::Replacements const &, inference::Replacements const &)>
+void BM_IntersectReplacements(benchmark::State & state)
+{
+  ScAddr const & x = makeAddr(0);
+  ScAddr const & y = makeAddr(1);
+  ScAddr const & z = makeAddr(2);
+  size_t const rowsAmount = state.range(0);
+  size_t const keysAmount = state.range(1);
+  bool const isClustered = state.range(2);
+  inference::Replacements const & first = makeReplacements(y, x, rowsAmount, keysAmount, isClustered, 1);
+  inference::Replacements const & second = makeReplacements(y, z, rowsAmount, keysAmount, isClustered, 2);
+
+  size_t resultRowsAmount = 0;
+  for (auto _ : state)
+  {
+    inference::Replacements const & result = Intersect(first, second);
+    resultRowsAmount = result.getRowsAmount();
+    benchmark::DoNotOptimize(resultRowsAmount);
+  }
+  state.counters["rows"] = static_cast<double>(resultRowsAmount);
+  state.SetItemsProcessed(state.iterations() * rowsAmount * 2);
+}
+
+// rows amount, keys amount, rows are clustered by key
+void JoinArguments(benchmark::internal::Benchmark * benchmark)
+{
+  for (int64_t const rowsAmount : {1 << 10, 1 << 13, 1 << 16})
+  {
+    for (int64_t const rowsPerKey : {1, 16})
+    {
+      for (int64_t const isClustered : {0, 1})
+        benchmark->Args({rowsAmount, rowsAmount / rowsPerKey, isClustered});
+    }
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_IntersectReplacements, inference::ReplacementsUtils::intersectReplacements)
+    ->Apply(JoinArguments)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_IntersectReplacements, inference::ReplacementsUtils::intersectReplacementsBySortMerge)
+    ->Apply(JoinArguments)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_IntersectReplacements, inference::ReplacementsUtils::intersectReplacementsInParallel)
+    ->Apply(JoinArguments)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+/**
+ * @brief Make edges {from, to} of a star: the hub has edges to and from each of other `nodesAmount` nodes. The star
+ * has no triangles but each pair of its edges joined by the hub is a path of two edges
+ */
+inference::Replacements makeStarEdges(ScAddr const & fromVariable, ScAddr const & toVariable, size_t nodesAmount)
+{
+  inference::Replacements edges(ScAddrVector{fromVariable, toVariable});
+  edges.reserve(nodesAmount * 2);
+  for (size_t node = 1; node <= nodesAmount; ++node)
+  {
+    edges.addRow({makeAddr(0), makeAddr(node)});
+    edges.addRow({makeAddr(node), makeAddr(0)});
+  }
+  return edges;
+}
+
+inference::Replacements intersectPairwise(std::vector<inference::Replacements> const & replacementsVector)
+{
+  inference::Replacements result = replacementsVector.front();
+  for (size_t index = 1; index < replacementsVector.size(); ++index)
+    result = inference::ReplacementsUtils::intersectReplacements(result, replacementsVector[index]);
+  return result;
+}
+
+template <inference::Replacements (*Intersect)(std::vector<inference::Replacements> const &)>
+void BM_IntersectTriangle(benchmark::State & state)
+{
+  ScAddr const & x = makeAddr(0);
+  ScAddr const & y = makeAddr(1);
+  ScAddr const & z = makeAddr(2);
+  size_t const nodesAmount = state.range(0);
+  std::vector<inference::Replacements> const edges = {
+      makeStarEdges(x, y, nodesAmount), makeStarEdges(y, z, nodesAmount), makeStarEdges(z, x, nodesAmount)};
+
+  size_t resultRowsAmount = 0;
+  for (auto _ : state)
+  {
+    inference::Replacements const & result = Intersect(edges);
+    resultRowsAmount = result.getRowsAmount();
+    benchmark::DoNotOptimize(resultRowsAmount);
+  }
+  state.counters["rows"] = static_cast<double>(resultRowsAmount);
+}
+
+BENCHMARK_TEMPLATE(BM_IntersectTriangle, intersectPairwise)
+    ->RangeMultiplier(4)
+    ->Range(1 << 6, 1 << 10)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_IntersectTriangle, inference::ReplacementsUtils::intersectReplacementsByGenericJoin)
+    ->RangeMultiplier(4)
+    ->Range(1 << 6, 1 << 10)
+    ->Unit(benchmark::kMicrosecond);
+
+void hashKeysByScalarKernel(ScAddr const * keys, size_t keySize, size_t keysAmount, uint64_t * hashes)
+{
+  for (size_t key = 0; key < keysAmount; ++key)
+    hashes[key] = inference::ReplacementsHashIndex::hashKey(keys + key * keySize, keySize);
+}
+
+template <void (*HashKeys)(ScAddr const *, size_t, size_t, uint64_t *)>
+void BM_HashKeys(benchmark::State & state)
+{
+  size_t const keySize = state.range(0);
+  size_t const keysAmount = 1 << 16;
+  ScAddrVector keys(keysAmount * keySize);
+  for (size_t index = 0; index < keys.size(); ++index)
+    keys[index] = makeAddr(index * 7919 % keys.size());
+  std::vector<uint64_t> hashes(keysAmount);
+
+  for (auto _ : state)
+  {
+    HashKeys(keys.data(), keySize, keysAmount, hashes.data());
+    benchmark::DoNotOptimize(hashes.data());
+  }
+  state.SetLabel(inference::ReplacementsKernels::getInstructionSet());
+  state.SetItemsProcessed(state.iterations() * keysAmount);
+}
+
+BENCHMARK_TEMPLATE(BM_HashKeys, hashKeysByScalarKernel)->DenseRange(1, 4)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_HashKeys, inference::ReplacementsKernels::hashKeys)
+    ->DenseRange(1, 4)
+    ->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Intersect memberships {element, class} of elements in few classes with relations {element, relation} of
+ * elements in few relations by element, as plain replacements or compressed ones. Counter `bytes` is memory taken
+ * by rows of both replacements
+ */
+template <bool isCompressed>
+void BM_IntersectMemberships(benchmark::State & state)
+{
+  ScAddr const & element = makeAddr(0);
+  ScAddr const & elementClass = makeAddr(1);
+  ScAddr const & relation = makeAddr(2);
+  size_t const rowsAmount = state.range(0);
+  size_t const elementsAmount = rowsAmount / 16;
+  inference::Replacements memberships(ScAddrVector{element, elementClass});
+  inference::Replacements relations(ScAddrVector{element, relation});
+  for (size_t row = 0; row < rowsAmount; ++row)
+    memberships.addRow({makeAddr(100 + row * 7919 % elementsAmount), makeAddr(10 + row % 64)});
+  for (size_t row = 0; row < elementsAmount; ++row)
+    relations.addRow({makeAddr(100 + row), makeAddr(90 - row % 16)});
+  if (isCompressed)
+  {
+    memberships.compress();
+    relations.compress();
+  }
+
+  for (auto _ : state)
+  {
+    inference::Replacements const & result =
+        inference::ReplacementsUtils::intersectReplacements(memberships, relations);
+    benchmark::DoNotOptimize(result.empty());
+  }
+  state.counters["bytes"] = memberships.getMemorySize() + relations.getMemorySize();
+  state.SetItemsProcessed(state.iterations() * rowsAmount);
+}
+
+BENCHMARK_TEMPLATE(BM_IntersectMemberships, false)
+    ->RangeMultiplier(16)
+    ->Range(1 << 12, 1 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_IntersectMemberships, true)
+    ->RangeMultiplier(16)
+    ->Range(1 << 12, 1 << 20)
+    ->Unit(benchmark::kMillisecond);
+}  // namespace inferenceBench
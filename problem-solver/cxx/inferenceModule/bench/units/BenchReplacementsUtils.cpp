@@ -0,0 +1,162 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "utils/ReplacementsUtils.hpp"
+#include "utils/TemplateParamsCursor.hpp"
+
+#include "ReplacementsGenerator.hpp"
+
+namespace inferenceBench
+{
+ReplacementsShape getShape(benchmark::State const & state)
+{
+  return {
+      static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1)), static_cast<size_t>(state.range(3))};
+}
+
+void finish(benchmark::State & state, size_t processedRowsAmount, size_t resultRowsAmount)
+{
+  state.counters["result"] = static_cast<double>(resultRowsAmount);
+  state.SetItemsProcessed(state.iterations() * processedRowsAmount);
+}
+
+/// Join replacements {key, first value} and {key, second value} on keys
+void BM_Intersect(benchmark::State & state)
+{
+  ReplacementsShape const & shape = getShape(state);
+  inference::Replacements const & first = generateReplacements(makeAddr(0), makeAddr(1), shape, 0, 1);
+  inference::Replacements const & second =
+      generateReplacements(makeAddr(0), makeAddr(2), shape, getOverlappingFirstKey(shape, state.range(2)), 2);
+
+  size_t resultRowsAmount = 0;
+  for (auto _ : state)
+  {
+    inference::Replacements const & result = inference::ReplacementsUtils::intersectReplacements(first, second);
+    resultRowsAmount = result.getRowsAmount();
+    benchmark::DoNotOptimize(resultRowsAmount);
+  }
+  finish(state, shape.rowsAmount * 2, resultRowsAmount);
+}
+
+/// Subtract replacements {key, value} from replacements of the same variables
+void BM_Subtract(benchmark::State & state)
+{
+  ReplacementsShape const & shape = getShape(state);
+  inference::Replacements const & first = generateReplacements(makeAddr(0), makeAddr(1), shape, 0, 1);
+  inference::Replacements const & second =
+      generateReplacements(makeAddr(0), makeAddr(1), shape, getOverlappingFirstKey(shape, state.range(2)), 2);
+
+  size_t resultRowsAmount = 0;
+  for (auto _ : state)
+  {
+    inference::Replacements const & result = inference::ReplacementsUtils::subtractReplacements(first, second);
+    resultRowsAmount = result.getRowsAmount();
+    benchmark::DoNotOptimize(resultRowsAmount);
+  }
+  finish(state, shape.rowsAmount * 2, resultRowsAmount);
+}
+
+/// Unite replacements {key, value} with replacements of the same variables
+void BM_Unite(benchmark::State & state)
+{
+  ReplacementsShape const & shape = getShape(state);
+  inference::Replacements const & first = generateReplacements(makeAddr(0), makeAddr(1), shape, 0, 1);
+  inference::Replacements const & second =
+      generateReplacements(makeAddr(0), makeAddr(1), shape, getOverlappingFirstKey(shape, state.range(2)), 2);
+
+  size_t resultRowsAmount = 0;
+  for (auto _ : state)
+  {
+    inference::Replacements const & result = inference::ReplacementsUtils::uniteReplacements(first, second);
+    resultRowsAmount = result.getRowsAmount();
+    benchmark::DoNotOptimize(resultRowsAmount);
+  }
+  finish(state, shape.rowsAmount * 2, resultRowsAmount);
+}
+
+/// Remove duplicate rows of a copy of replacements, the copy shares rows until they are changed
+void BM_RemoveDuplicateRows(benchmark::State & state)
+{
+  ReplacementsShape const & shape = getShape(state);
+  inference::Replacements const & replacements = generateReplacements(makeAddr(0), makeAddr(1), shape, 0, 1);
+
+  size_t resultRowsAmount = 0;
+  for (auto _ : state)
+  {
+    inference::Replacements result = replacements;
+    result.removeDuplicateRows();
+    resultRowsAmount = result.getRowsAmount();
+    benchmark::DoNotOptimize(resultRowsAmount);
+  }
+  finish(state, shape.rowsAmount, resultRowsAmount);
+}
+
+/// Create template params for all rows at once
+void BM_ReplacementsToScTemplateParams(benchmark::State & state)
+{
+  ReplacementsShape const & shape = getShape(state);
+  inference::Replacements const & replacements = generateReplacements(makeAddr(0), makeAddr(1), shape, 0, 1);
+
+  for (auto _ : state)
+  {
+    auto const & paramsVector = inference::ReplacementsUtils::getReplacementsToScTemplateParams(replacements);
+    benchmark::DoNotOptimize(paramsVector.data());
+  }
+  finish(state, shape.rowsAmount, shape.rowsAmount);
+}
+
+/// Create template params row by row, as searchers consume them
+void BM_TemplateParamsCursor(benchmark::State & state)
+{
+  ReplacementsShape const & shape = getShape(state);
+  inference::Replacements const & replacements = generateReplacements(makeAddr(0), makeAddr(1), shape, 0, 1);
+
+  for (auto _ : state)
+  {
+    inference::TemplateParamsCursor paramsCursor(replacements);
+    while (paramsCursor.next())
+      benchmark::DoNotOptimize(&paramsCursor.getParams());
+  }
+  finish(state, shape.rowsAmount, shape.rowsAmount);
+}
+
+// rows amount, keys amount, percents of overlapping keys, percents of duplicate rows
+void ShapeArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"rows", "keys", "overlap", "duplicates"});
+  for (int64_t const rowsAmount : {1 << 12, 1 << 16})
+  {
+    for (int64_t const rowsPerKey : {1, 16})
+    {
+      for (int64_t const overlapPercent : {10, 90})
+      {
+        for (int64_t const duplicatesPercent : {0, 50})
+          benchmark->Args({rowsAmount, rowsAmount / rowsPerKey, overlapPercent, duplicatesPercent});
+      }
+    }
+  }
+}
+
+// rows amount, keys amount, overlap is not used, percents of duplicate rows
+void SingleShapeArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"rows", "keys", "overlap", "duplicates"});
+  for (int64_t const rowsAmount : {1 << 12, 1 << 16})
+  {
+    for (int64_t const duplicatesPercent : {0, 50})
+      benchmark->Args({rowsAmount, rowsAmount / 16, 0, duplicatesPercent});
+  }
+}
+
+BENCHMARK(BM_Intersect)->Apply(ShapeArguments)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Subtract)->Apply(ShapeArguments)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Unite)->Apply(ShapeArguments)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RemoveDuplicateRows)->Apply(SingleShapeArguments)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ReplacementsToScTemplateParams)->Apply(SingleShapeArguments)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TemplateParamsCursor)->Apply(SingleShapeArguments)->Unit(benchmark::kMicrosecond);
+}  // namespace inferenceBench
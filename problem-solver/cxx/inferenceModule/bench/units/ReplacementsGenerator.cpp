@@ -0,0 +1,60 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ReplacementsGenerator.hpp"
+
+#include <algorithm>
+#include <random>
+
+namespace inferenceBench
+{
+size_t const VALUES_OFFSET = 1 << 24;
+
+ScAddr makeAddr(size_t index)
+{
+  sc_addr addr;
+  addr.seg = static_cast<sc_addr_seg>(index / 65000 + 1);
+  addr.offset = static_cast<sc_addr_offset>(index % 65000 + 1);
+  return ScAddr(addr);
+}
+
+inference::Replacements generateReplacements(
+    ScAddr const & keyVariable,
+    ScAddr const & valueVariable,
+    ReplacementsShape const & shape,
+    size_t firstKey,
+    size_t seed)
+{
+  size_t const keysAmount = std::max<size_t>(shape.keysAmount, 1);
+  size_t const valuesPerKey = std::max<size_t>(shape.rowsAmount / keysAmount, 1);
+  std::mt19937_64 random(seed);
+
+  inference::Replacements replacements(ScAddrVector{keyVariable, valueVariable});
+  replacements.reserve(shape.rowsAmount);
+  std::vector<std::pair<size_t, size_t>> rows;
+  rows.reserve(shape.rowsAmount);
+  for (size_t row = 0; row < shape.rowsAmount; ++row)
+  {
+    if (!rows.empty() && random() % 100 < shape.duplicatesPercent)
+    {
+      rows.push_back(rows[random() % rows.size()]);
+    }
+    else
+    {
+      size_t const key = firstKey + random() % keysAmount;
+      rows.emplace_back(key, VALUES_OFFSET + key * valuesPerKey + random() % valuesPerKey);
+    }
+    replacements.addRow({makeAddr(rows.back().first), makeAddr(rows.back().second)});
+  }
+  return replacements;
+}
+
+size_t getOverlappingFirstKey(ReplacementsShape const & shape, size_t overlapPercent)
+{
+  return shape.keysAmount * (100 - std::min<size_t>(overlapPercent, 100)) / 100;
+}
+
+}  // namespace inferenceBench
@@ -0,0 +1,41 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include "utils/ReplacementsTable.hpp"
+
+namespace inferenceBench
+{
+/// @returns a distinct addr for each index, so tables can be generated without a memory context
+ScAddr makeAddr(size_t index);
+
+/**
+ * @brief Shape of synthetic replacements {key, value}: `rowsAmount` rows with keys from `keysAmount` distinct keys,
+ * `duplicatesPercent` percents of rows repeat earlier rows
+ */
+struct ReplacementsShape
+{
+  size_t rowsAmount;
+  size_t keysAmount;
+  size_t duplicatesPercent;
+};
+
+/**
+ * @brief Generate replacements {key, value} of the shape with keys starting from `firstKey`. Values depend only on
+ * keys, so replacements of the same variables with overlapping key ranges share rows as well as keys
+ */
+inference::Replacements generateReplacements(
+    ScAddr const & keyVariable,
+    ScAddr const & valueVariable,
+    ReplacementsShape const & shape,
+    size_t firstKey,
+    size_t seed);
+
+/// @returns the first key of replacements which share `overlapPercent` percents of keys with replacements of the shape
+size_t getOverlappingFirstKey(ReplacementsShape const & shape, size_t overlapPercent);
+
+}  // namespace inferenceBench
@@ -32,6 +32,7 @@ std::unique_ptr<InferenceManagerAbstract> InferenceManagerFactory::constructDire
     solutionTreeManager = std::make_unique<SolutionTreeManagerEmpty>(context);
   }
   strategyAll->setSolutionTreeManager(solutionTreeManager);
+  strategyAll->setMemoryBudget(inferenceFlowConfig.memoryBudget);
 
   std::shared_ptr<TemplateManagerAbstract> templateManager = std::make_shared<TemplateManagerFixedArguments>(context);
   templateManager->setReplacementsUsingType(inferenceFlowConfig.replacementsUsingType);
@@ -78,6 +79,7 @@ std::unique_ptr<InferenceManagerAbstract> InferenceManagerFactory::constructDire
     solutionTreeManager = std::make_unique<SolutionTreeManagerEmpty>(context);
   }
   strategyTarget->setSolutionTreeManager(solutionTreeManager);
+  strategyTarget->setMemoryBudget(inferenceFlowConfig.memoryBudget);
 
   std::shared_ptr<TemplateManagerAbstract> templateManager = std::make_shared<TemplateManager>(context);
   templateManager->setReplacementsUsingType(inferenceFlowConfig.replacementsUsingType);
@@ -54,6 +54,8 @@ struct InferenceConfig
   SearchType searchType;
   OutputStructureFillingType fillingType;
   AtomicLogicalFormulaSearchBeforeGenerationType atomicLogicalFormulaSearchBeforeGenerationType;
+  /// greatest amount of bytes of replacements rows kept in memory, rows beyond it are spilled to files, 0 for no limit
+  size_t memoryBudget = 0;
 };
 
 struct InferenceParams
@@ -6,6 +6,10 @@
 
 #include "ConjunctionExpressionNode.hpp"
 
+#include <algorithm>
+
+#include "utils/ReplacementsStreamingIntersection.hpp"
+
 ConjunctionExpressionNode::ConjunctionExpressionNode(
     ScMemoryContext * context,
     OperatorLogicExpressionNode::OperandsVector & operands)
@@ -20,6 +24,8 @@ void ConjunctionExpressionNode::compute(LogicFormulaResult & result) const
   result.value = false;
   vector<TemplateExpressionNode *> formulasWithoutConstants;
   vector<TemplateExpressionNode *> formulasToGenerate;
+  vector<TemplateExpressionNode *> formulasToSearch;
+  vector<LogicExpressionNode *> formulasToCompute;
 
   for (auto const & operand : operands)
   {
@@ -39,6 +45,51 @@ void ConjunctionExpressionNode::compute(LogicFormulaResult & result) const
         formulasToGenerate.push_back(atom);
         continue;
       }
+      formulasToSearch.push_back(atom);
+    }
+    formulasToCompute.push_back(operand.get());
+  }
+  // many atoms are joined at once, so intermediate results of cyclic patterns do not grow beyond the joined result.
+  // If REPLACEMENTS_FIRST is used each atom has a single row, so atoms are joined one by one by searching rows until
+  // a joined row is found
+  bool const isFirstReplacementUsed = std::any_of(
+      formulasToSearch.cbegin(), formulasToSearch.cend(), [](TemplateExpressionNode const * atom) {
+        return atom->getReplacementsUsingType() == REPLACEMENTS_FIRST;
+      });
+  if (!isFirstReplacementUsed && formulasToSearch.size() >= ReplacementsUtils::GENERIC_JOIN_MIN_REPLACEMENTS_AMOUNT)
+  {
+    SC_LOG_DEBUG("Join " << formulasToSearch.size() << " atoms in conjunction by generic join");
+    if (!joinSearchedAtoms(formulasToSearch, result))
+    {
+      result.value = false;
+      result.isGenerated = false;
+      result.replacements = {};
+      return;
+    }
+    formulasToCompute.erase(
+        std::remove_if(
+            formulasToCompute.begin(),
+            formulasToCompute.end(),
+            [](LogicExpressionNode * operand) {
+              return dynamic_cast<TemplateExpressionNode *>(operand) != nullptr;
+            }),
+        formulasToCompute.end());
+  }
+
+  for (auto const & operand : formulasToCompute)
+  {
+    auto atom = dynamic_cast<TemplateExpressionNode *>(operand);
+    // replacements without rows, for example of a negation, do not restrict the atom, so its rows are not streamed
+    if (atom && result.value && result.replacements.getRowsAmount() > 0)
+    {
+      if (!intersectWithSearchedRows(*atom, result.replacements))
+      {
+        result.value = false;
+        result.isGenerated = false;
+        result.replacements = {};
+        return;
+      }
+      continue;
     }
     LogicFormulaResult lastResult;
     operand->compute(lastResult);
@@ -50,10 +101,10 @@ void ConjunctionExpressionNode::compute(LogicFormulaResult & result) const
       return;
     }
     if (!result.value)  // this is true only when processing the first operand
-      result = lastResult;
+      result = std::move(lastResult);
     else
     {
-      result.replacements = ReplacementsUtils::intersectReplacements(result.replacements, lastResult.replacements);
+      result.replacements = intersectReplacements(result.replacements, lastResult.replacements);
       if (result.replacements.empty())
       {
         result.value = false;
@@ -73,7 +124,7 @@ void ConjunctionExpressionNode::compute(LogicFormulaResult & result) const
       result.replacements = {};
       return;
     }
-    result.replacements = ReplacementsUtils::intersectReplacements(result.replacements, lastResult.replacements);
+    result.replacements = intersectReplacements(result.replacements, lastResult.replacements);
     if (result.replacements.empty())
     {
       result.value = false;
@@ -92,7 +143,7 @@ void ConjunctionExpressionNode::compute(LogicFormulaResult & result) const
       result.replacements = {};
       return;
     }
-    result.replacements = ReplacementsUtils::intersectReplacements(result.replacements, lastResult.replacements);
+    result.replacements = intersectReplacements(result.replacements, lastResult.replacements);
     if (result.replacements.empty())
     {
       result.value = false;
@@ -103,7 +154,7 @@ void ConjunctionExpressionNode::compute(LogicFormulaResult & result) const
   }
 }
 
-LogicFormulaResult ConjunctionExpressionNode::generate(Replacements & replacements)
+LogicFormulaResult ConjunctionExpressionNode::generate(Replacements const & replacements)
 {
   LogicFormulaResult fail = {false, false, {}};
   LogicFormulaResult globalResult = {true, false, replacements};
@@ -113,10 +164,57 @@ LogicFormulaResult ConjunctionExpressionNode::generate(Replacements & replacemen
     if (!lastResult.value)
       return fail;
     globalResult.isGenerated |= lastResult.isGenerated;
-    globalResult.replacements =
-        ReplacementsUtils::intersectReplacements(globalResult.replacements, lastResult.replacements);
-    if (ReplacementsUtils::getColumnsAmount(globalResult.replacements) == 0)
+    globalResult.replacements = intersectReplacements(globalResult.replacements, lastResult.replacements);
+    if (globalResult.replacements.empty())
       return fail;
   }
   return globalResult;
 }
+
+bool ConjunctionExpressionNode::intersectWithSearchedRows(
+    TemplateExpressionNode const & atom,
+    Replacements & replacements)
+{
+  ReplacementsStreamingIntersection intersection(replacements);
+  bool const isFirstReplacementUsed = atom.getReplacementsUsingType() == REPLACEMENTS_FIRST;
+  Replacements searchedReplacements;
+  // searched rows are joined and removed one by one, so all rows of the atom are never stored together
+  atom.search(searchedReplacements, [&intersection, isFirstReplacementUsed](Replacements & searchedRows) {
+    intersection.addRows(searchedRows);
+    searchedRows.truncate(0);
+    return !isFirstReplacementUsed || intersection.empty();
+  });
+  intersection.addRows(searchedReplacements);
+  replacements = intersection.getResult();
+  return !replacements.empty();
+}
+
+bool ConjunctionExpressionNode::joinSearchedAtoms(
+    vector<TemplateExpressionNode *> const & atoms,
+    LogicFormulaResult & result)
+{
+  std::vector<Replacements> atomsReplacements;
+  atomsReplacements.reserve(atoms.size());
+  for (auto const & atom : atoms)
+  {
+    LogicFormulaResult atomResult;
+    atom->compute(atomResult);
+    if (!atomResult.value)
+      return false;
+    atomsReplacements.push_back(std::move(atomResult.replacements));
+  }
+  result.replacements = ReplacementsUtils::intersectReplacementsByGenericJoin(atomsReplacements);
+  result.value = !result.replacements.empty();
+  result.isGenerated = false;
+  return result.value;
+}
+
+Replacements ConjunctionExpressionNode::intersectReplacements(Replacements const & first, Replacements const & second)
+{
+  if (ReplacementsUtils::isSortMergeIntersectionPreferred(first, second))
+  {
+    SC_LOG_DEBUG("Intersect replacements by sort-merge join");
+    return ReplacementsUtils::intersectReplacementsBySortMerge(first, second);
+  }
+  return ReplacementsUtils::intersectReplacements(first, second);
+}
@@ -17,7 +17,7 @@ public:
 
   void compute(LogicFormulaResult & result) const override;
 
-  LogicFormulaResult generate(Replacements & replacements) override;
+  LogicFormulaResult generate(Replacements const & replacements) override;
 
   ScAddr getFormula() const override
   {
@@ -26,4 +26,19 @@ public:
 
 private:
   ScMemoryContext * context;
+
+  /**
+   * @brief Search the atom and intersect found rows with the replacements as soon as they are found. If
+   * REPLACEMENTS_FIRST is used the search stops after the first row that is intersected with the replacements
+   * @return true if the intersection is not empty
+   */
+  static bool intersectWithSearchedRows(TemplateExpressionNode const & atom, Replacements & replacements);
+
+  /// Compute atoms and intersect all their replacements at once by generic join, it is not used with
+  /// REPLACEMENTS_FIRST because each atom is computed with its first row only
+  /// @return true if the intersection is not empty
+  static bool joinSearchedAtoms(vector<TemplateExpressionNode *> const & atoms, LogicFormulaResult & result);
+
+  /// Intersect replacements by sort-merge join if both are big and of close sizes and by hash join otherwise
+  static Replacements intersectReplacements(Replacements const & first, Replacements const & second);
 };
@@ -42,7 +42,7 @@ void EquivalenceExpressionNode::compute(LogicFormulaResult & result) const
     }
     LogicFormulaResult subFormulaResult;
     operand->compute(subFormulaResult);
-    subFormulaResults.push_back(subFormulaResult);
+    subFormulaResults.push_back(std::move(subFormulaResult));
   }
   SC_LOG_DEBUG("Processed " << subFormulaResults.size() << " formulas in equivalence");
   if (subFormulaResults.empty())
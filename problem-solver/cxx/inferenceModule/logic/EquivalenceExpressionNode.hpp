@@ -17,7 +17,7 @@ public:
 
   void compute(LogicFormulaResult & result) const override;
 
-  LogicFormulaResult generate(Replacements & replacements) override
+  LogicFormulaResult generate(Replacements const & replacements) override
   {
     return {false, false, {}};
   }
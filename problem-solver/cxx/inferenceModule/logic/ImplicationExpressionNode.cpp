@@ -28,7 +28,8 @@ void ImplicationExpressionNode::compute(LogicFormulaResult & result) const
   LogicExpressionNode * conclusionAtom = operands[1].get();
   conclusionAtom->setArgumentVector(argumentVector);
 
-  // Compute premise formula, get replacements with found constructions
+  // Compute premise formula, get replacements with found constructions. Conclusion is generated after the premise
+  // search is finished, so the premise never finds constructions generated by the conclusion
   LogicFormulaResult premiseResult;
   premiseAtom->compute(premiseResult);
 
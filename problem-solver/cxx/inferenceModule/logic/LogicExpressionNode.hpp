@@ -6,7 +6,7 @@
 
 #pragma once
 
-#include "utils/Types.hpp"
+#include "utils/ReplacementsTable.hpp"
 
 namespace inference
 {
@@ -27,7 +27,7 @@ public:
   virtual ScAddr getFormula() const = 0;
   virtual ~LogicExpressionNode() = default;
 
-  virtual LogicFormulaResult generate(Replacements & replacements) = 0;
+  virtual LogicFormulaResult generate(Replacements const & replacements) = 0;
 
   void setArgumentVector(ScAddrVector const & otherArgumentVector)
   {
@@ -50,26 +50,52 @@ void TemplateExpressionNode::compute(LogicFormulaResult & result) const
     templateSearcher->searchTemplate(formula, ScTemplateParams(), variables, replacements);
   }
 
-  result.replacements = replacements;
+  // big searched replacements repeat few values in their columns and are kept until other formulas are computed
+  if (replacements.getRowsAmount() >= ReplacementsUtils::COMPRESSION_MIN_ROWS_AMOUNT)
+    replacements.compress();
+  result.replacements = std::move(replacements);
   result.value = !result.replacements.empty();
   SC_LOG_DEBUG(
       "Compute atomic logical formula " << context->HelperGetSystemIdtf(formula)
                                         << (result.value ? " true" : " false"));
 }
 
-LogicFormulaResult TemplateExpressionNode::find(Replacements & replacements) const
+bool TemplateExpressionNode::search(Replacements & replacements, ReplacementsConsumer const & consumer) const
+{
+  bool isFound = false;
+  ReplacementsConsumer const & foundRowsConsumer = [&consumer, &isFound](Replacements & foundReplacements) {
+    isFound = true;
+    return consumer(foundReplacements);
+  };
+  ScAddrHashSet variables;
+  templateSearcher->getVariables(formula, variables);
+  if (!argumentVector.empty())
+  {
+    std::vector<ScTemplateParams> const & templateParamsVector = templateManager->createTemplateParams(formula);
+    templateSearcher->searchTemplate(formula, templateParamsVector, variables, replacements, foundRowsConsumer);
+  }
+  else
+  {
+    templateSearcher->searchTemplate(formula, ScTemplateParams(), variables, replacements, foundRowsConsumer);
+  }
+
+  SC_LOG_DEBUG(
+      "Search atomic logical formula " << context->HelperGetSystemIdtf(formula) << (isFound ? " true" : " false"));
+  return isFound;
+}
+
+LogicFormulaResult TemplateExpressionNode::find(Replacements const & replacements) const
 {
   LogicFormulaResult result;
-  std::vector<ScTemplateParams> paramsVector =
-      ReplacementsUtils::getReplacementsToScTemplateParams(getReplacementsWithoutEdges(replacements));
+  TemplateParamsCursor paramsCursor(getReplacementsWithoutEdges(replacements));
   Replacements resultReplacements;
   ScAddrHashSet variables;
   templateSearcher->getVariables(formula, variables);
   SC_LOG_DEBUG(
-      "TemplateExpressionNode: call search for " << (paramsVector.empty() ? "empty" : to_string(paramsVector.size()))
-                                                 << " params");
-  templateSearcher->searchTemplate(formula, paramsVector, variables, resultReplacements);
-  result.replacements = resultReplacements;
+      "TemplateExpressionNode: call search for "
+      << (paramsCursor.getRowsAmount() == 0 ? "empty" : to_string(paramsCursor.getRowsAmount())) << " params");
+  templateSearcher->searchTemplate(formula, paramsCursor, variables, resultReplacements);
+  result.replacements = std::move(resultReplacements);
   result.value = !result.replacements.empty();
 
 
@@ -79,15 +105,17 @@ LogicFormulaResult TemplateExpressionNode::find(Replacements & replacements) con
   return result;
 }
 
-Replacements TemplateExpressionNode::getReplacementsWithoutEdges(Replacements const & replacements) const
+Replacements::Projection TemplateExpressionNode::getReplacementsWithoutEdges(
+    Replacements const & replacements) const
 {
   ScAddrHashSet edges;
-  for (auto const & replacement : replacements)
+  for (ScAddr const & variable : replacements.getVariables())
   {
-    if (context->GetElementType(replacement.first).IsEdge())
-      edges.insert(replacement.first);
+    if (context->GetElementType(variable).IsEdge())
+      edges.insert(variable);
   }
-  return ReplacementsUtils::removeRows(replacements, edges);
+  // the projection is a view on rows of the given replacements, so they are not copied
+  return replacements.projectWithout(edges);
 }
 
 /**
@@ -95,10 +123,10 @@ Replacements TemplateExpressionNode::getReplacementsWithoutEdges(Replacements co
  * @param replacements variables and ScAddrs to use in generation
  * @return LogicFormulaResult{bool: value, bool: isGenerated, Replacements: replacements}
  */
-LogicFormulaResult TemplateExpressionNode::generate(Replacements & replacements)
+LogicFormulaResult TemplateExpressionNode::generate(Replacements const & replacements)
 {
   LogicFormulaResult result;
-  if (ReplacementsUtils::getColumnsAmount(replacements) == 0)
+  if (replacements.empty())
   {
     SC_LOG_DEBUG("Atomic logical formula " << context->HelperGetSystemIdtf(formula) << " is not generated");
     return result;
@@ -111,9 +139,10 @@ LogicFormulaResult TemplateExpressionNode::generate(Replacements & replacements)
   Replacements const & existingFormulaReplacements = getSearchResultWithoutReplacementsIfNeeded();
 
   size_t count = 0;
-  Replacements searchResult;
-  Replacements generatedReplacements;
-  if (templateManager->getGenerationType() == GENERATE_UNIQUE_FORMULAS)
+  Replacements searchResult(formulaVariables);
+  Replacements generatedReplacements(formulaVariables);
+  // without existing formula replacements there is nothing to subtract, so replacements are not copied
+  if (templateManager->getGenerationType() == GENERATE_UNIQUE_FORMULAS && !existingFormulaReplacements.empty())
   {
     // replacementsNotInKb stores all replacements from passed to TemplateExpressionNode::generate parameter that don't
     // have corresponding columns in existingFormulaReplacements
@@ -162,29 +191,28 @@ void TemplateExpressionNode::generateByReplacements(
     Replacements & searchResult,
     Replacements & generatedReplacements)
 {
-  Replacements const & replacementsWithoutEdges = getReplacementsWithoutEdges(replacements);
-  std::vector<ScTemplateParams> const & paramsVector =
-      ReplacementsUtils::getReplacementsToScTemplateParams(replacementsWithoutEdges);
-  processTemplateParams(paramsVector, formulaVariables, result, count, searchResult, generatedReplacements);
+  TemplateParamsCursor paramsCursor(getReplacementsWithoutEdges(replacements));
+  processTemplateParams(paramsCursor, formulaVariables, result, count, searchResult, generatedReplacements);
 }
 
 void TemplateExpressionNode::processTemplateParams(
-    vector<ScTemplateParams> const & paramsVector,
+    TemplateParamsCursor & paramsCursor,
     ScAddrHashSet const & formulaVariables,
     LogicFormulaResult & result,
     size_t & count,
     Replacements & searchResult,
     Replacements & generatedReplacements)
 {
-  for (ScTemplateParams const & params : paramsVector)
+  while (paramsCursor.next())
   {
+    ScTemplateParams const & params = paramsCursor.getParams();
     if (templateManager->getReplacementsUsingType() == REPLACEMENTS_FIRST && result.isGenerated)
       return;
-    size_t const previousSearchSize = ReplacementsUtils::getColumnsAmount(searchResult);
+    size_t const previousSearchSize = searchResult.getRowsAmount();
     if (templateManager->getGenerationType() == GENERATE_UNIQUE_FORMULAS)
       templateSearcherGeneral->searchTemplate(formula, params, formulaVariables, searchResult);
     if (templateManager->getGenerationType() != GENERATE_UNIQUE_FORMULAS ||
-        ReplacementsUtils::getColumnsAmount(searchResult) == previousSearchSize)
+        searchResult.getRowsAmount() == previousSearchSize)
       generateByParams(params, formulaVariables, generatedReplacements, result, count);
   }
 }
@@ -197,7 +225,7 @@ void TemplateExpressionNode::generateByParams(
     size_t & count)
 {
   ScTemplate generatedTemplate;
-  context->HelperBuildTemplate(generatedTemplate, formula, params);
+  templateSearcherGeneral->buildTemplate(formula, params, generatedTemplate);
 
   ScTemplateGenResult generationResult;
   ScTemplate::Result const & scTemplateResult = context->HelperGenTemplate(generatedTemplate, generationResult);
@@ -206,12 +234,12 @@ void TemplateExpressionNode::generateByParams(
     ++count;
     result.isGenerated = true;
     result.value = true;
-    for (ScAddr const & variable : formulaVariables)
+    ScAddrVector const & variables = generatedReplacements.getVariables();
+    ScAddr * row = generatedReplacements.addRow();
+    for (size_t column = 0; column < variables.size(); ++column)
     {
-      ScAddr outAddr;
-      if (generationResult.Get(variable, outAddr) || params.Get(variable, outAddr))
-        generatedReplacements[variable].push_back(outAddr);
-      else
+      ScAddr const & variable = variables[column];
+      if (!generationResult.Get(variable, row[column]) && !params.Get(variable, row[column]))
         SC_THROW_EXCEPTION(
             utils::ExceptionInvalidState,
             "generation result and template params do not have replacement for "
@@ -229,17 +257,17 @@ void TemplateExpressionNode::fillOutputStructure(
 {
   if (outputStructure.IsValid() && templateManager->getFillingType() == SEARCHED_AND_GENERATED)
   {
-    if (ReplacementsUtils::getColumnsAmount(resultWithoutReplacements) > 0)
+    if (!resultWithoutReplacements.empty())
     {
       Replacements const & alreadyExistedBeforeGenerationReplacements =
           ReplacementsUtils::intersectReplacements(replacements, resultWithoutReplacements);
-      if (ReplacementsUtils::getColumnsAmount(alreadyExistedBeforeGenerationReplacements) > 0)
+      if (!alreadyExistedBeforeGenerationReplacements.empty())
       {
         addToOutputStructure(alreadyExistedBeforeGenerationReplacements, formulaVariables);
         addFormulaConstantsToOutputStructure();
       }
     }
-    if (ReplacementsUtils::getColumnsAmount(searchResult) > 0)
+    if (!searchResult.empty())
     {
       addToOutputStructure(searchResult, formulaVariables);
       addFormulaConstantsToOutputStructure();
@@ -258,13 +286,11 @@ void TemplateExpressionNode::addToOutputStructure(Replacements const & replaceme
 {
   if (outputStructure.IsValid())
   {
-    for (auto const & pair : replacements)
+    Replacements::Projection const & projection = replacements.project({variables.cbegin(), variables.cend()});
+    for (size_t row = 0; row < projection.getRowsAmount(); ++row)
     {
-      if (variables.find(pair.first) != variables.cend())
-      {
-        for (auto const & replacement : pair.second)
-          addToOutputStructure(replacement);
-      }
+      for (size_t column = 0; column < projection.getColumnsAmount(); ++column)
+        addToOutputStructure(projection.get(row, column));
     }
   }
 }
@@ -293,5 +319,6 @@ void TemplateExpressionNode::addToOutputStructure(ScAddr const & element)
   {
     context->CreateEdge(ScType::EdgeAccessConstPosPerm, outputStructure, element);
     outputStructureElements.insert(element);
+    templateSearcher->onStructureElementAdded(outputStructure, element);
   }
 }
@@ -28,15 +28,26 @@ public:
       ScAddr const & formula);
 
   void compute(LogicFormulaResult & result) const override;
+  /**
+   * @brief Search the formula like `compute` but pass found rows to the consumer as soon as they are found
+   * @param replacements is a table the found rows are added to, rows not taken by the consumer are left in it
+   * @return true if any row is found
+   */
+  bool search(Replacements & replacements, ReplacementsConsumer const & consumer) const;
   // TODO: remove useless method. Use compute instead of find
-  LogicFormulaResult find(Replacements & replacements) const;
-  LogicFormulaResult generate(Replacements & replacements) override;
+  LogicFormulaResult find(Replacements const & replacements) const;
+  LogicFormulaResult generate(Replacements const & replacements) override;
 
   ScAddr getFormula() const override
   {
     return formula;
   }
 
+  ReplacementsUsingType getReplacementsUsingType() const
+  {
+    return templateSearcher->getReplacementsUsingType();
+  }
+
 private:
   ScMemoryContext * context;
 
@@ -61,9 +72,9 @@ private:
       Replacements & generatedReplacements,
       LogicFormulaResult & result,
       size_t & count);
-  Replacements getReplacementsWithoutEdges(Replacements const & replacements) const;
+  Replacements::Projection getReplacementsWithoutEdges(Replacements const & replacements) const;
   void processTemplateParams(
-      vector<ScTemplateParams> const & paramsVector,
+      TemplateParamsCursor & paramsCursor,
       ScAddrHashSet const & formulaVariables,
       LogicFormulaResult & result,
       size_t & count,
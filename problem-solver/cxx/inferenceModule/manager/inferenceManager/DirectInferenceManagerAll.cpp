@@ -8,6 +8,8 @@
 
 #include "keynodes/InferenceKeynodes.hpp"
 
+#include "utils/InferenceArena.hpp"
+
 using namespace inference;
 
 DirectInferenceManagerAll::DirectInferenceManagerAll(ScMemoryContext * context)
@@ -17,6 +19,8 @@ DirectInferenceManagerAll::DirectInferenceManagerAll(ScMemoryContext * context)
 
 bool DirectInferenceManagerAll::applyInference(InferenceParams const & inferenceParamsConfig)
 {
+  // replacements of this inference run are allocated from the arena, it is declared first to be destroyed last
+  InferenceArena const arena(memoryBudget);
   bool result = false;
 
   templateManager->setArguments(inferenceParamsConfig.arguments);
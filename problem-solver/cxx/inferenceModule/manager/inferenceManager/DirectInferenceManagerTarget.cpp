@@ -9,6 +9,7 @@
 #include "sc-agents-common/utils/IteratorUtils.hpp"
 
 #include "utils/ContainersUtils.hpp"
+#include "utils/InferenceArena.hpp"
 #include "utils/ReplacementsUtils.hpp"
 
 using namespace inference;
@@ -20,6 +21,8 @@ DirectInferenceManagerTarget::DirectInferenceManagerTarget(ScMemoryContext * con
 
 bool DirectInferenceManagerTarget::applyInference(InferenceParams const & inferenceParamsConfig)
 {
+  // replacements of this inference run are allocated from the arena, it is declared first to be destroyed last
+  InferenceArena const arena(memoryBudget);
   templateManager->setArguments(inferenceParamsConfig.arguments);
   templateSearcher->setInputStructures(inferenceParamsConfig.inputStructures);
   setTargetStructure(inferenceParamsConfig.targetStructure);
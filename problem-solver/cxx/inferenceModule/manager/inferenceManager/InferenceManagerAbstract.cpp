@@ -36,6 +36,11 @@ void InferenceManagerAbstract::setSolutionTreeManager(std::shared_ptr<SolutionTr
   solutionTreeManager = std::move(manager);
 }
 
+void InferenceManagerAbstract::setMemoryBudget(size_t otherMemoryBudget)
+{
+  memoryBudget = otherMemoryBudget;
+}
+
 std::shared_ptr<SolutionTreeManagerAbstract> InferenceManagerAbstract::getSolutionTreeManager()
 {
   return solutionTreeManager;
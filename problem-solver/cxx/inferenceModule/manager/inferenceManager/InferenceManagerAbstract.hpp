@@ -30,6 +30,8 @@ public:
   void setTemplateSearcher(std::shared_ptr<TemplateSearcherAbstract> searcher);
   void setTemplateManager(std::shared_ptr<TemplateManagerAbstract> manager);
   void setSolutionTreeManager(std::shared_ptr<SolutionTreeManagerAbstract> manager);
+  /// @param memoryBudget greatest amount of bytes of replacements rows kept in memory by inference, 0 for no limit
+  void setMemoryBudget(size_t memoryBudget);
 
   std::shared_ptr<SolutionTreeManagerAbstract> getSolutionTreeManager();
 
@@ -61,6 +63,8 @@ protected:
   std::shared_ptr<TemplateSearcherAbstract> templateSearcher;
   std::shared_ptr<SolutionTreeManagerAbstract> solutionTreeManager;
 
+  size_t memoryBudget = 0;
+
   std::unordered_set<ScAddr, ScAddrHashFunc<::size_t>> outputStructureElements;
 };
 }  // namespace inference
@@ -5,6 +5,7 @@
  */
 
 #include "utils/ReplacementsUtils.hpp"
+#include "utils/TemplateParamsCursor.hpp"
 
 #include "SolutionTreeManager.hpp"
 
@@ -17,13 +18,12 @@ SolutionTreeManager::SolutionTreeManager(ScMemoryContext * context)
 
 bool SolutionTreeManager::addNode(ScAddr const & formula, Replacements const & replacements)
 {
-  std::vector<ScTemplateParams> const & templateParamsVector =
-      ReplacementsUtils::getReplacementsToScTemplateParams(replacements);
   ScAddrHashSet variables;
   ReplacementsUtils::getKeySet(replacements, variables);
+  TemplateParamsCursor cursor(replacements);
   bool result = true;
-  for (ScTemplateParams const & templateParams : templateParamsVector)
-    result &= solutionTreeGenerator->addNode(formula, templateParams, variables);
+  while (cursor.next())
+    result &= solutionTreeGenerator->addNode(formula, cursor.getParams(), variables);
   return result;
 }
 
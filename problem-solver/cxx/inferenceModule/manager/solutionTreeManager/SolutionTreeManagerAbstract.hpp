@@ -13,7 +13,7 @@
 
 #include "generator/SolutionTreeGenerator.hpp"
 #include "searcher/solutionTreeSearcher/SolutionTreeSearcher.hpp"
-#include "utils/Types.hpp"
+#include "utils/ReplacementsTable.hpp"
 
 namespace inference
 {
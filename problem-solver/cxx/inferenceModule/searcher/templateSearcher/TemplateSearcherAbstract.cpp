@@ -8,18 +8,57 @@
 
 #include "sc-agents-common/utils/CommonUtils.hpp"
 
+#include "utils/InferenceArena.hpp"
+#include "utils/ThreadPool.hpp"
+
 using namespace inference;
 
+namespace
+{
+/**
+ * @brief Add values which params bind to variables of bound values, unbound variables get empty values. Params with
+ * the same bound values give the same search results, so the template is searched once for each group of them
+ * @returns true if no params added before bind the same values
+ */
+bool addParamsGroup(ScTemplateParams const & params, ReplacementsBuilder & boundValuesBuilder)
+{
+  ScAddrVector const & variables = boundValuesBuilder.getVariables();
+  ScAddr * row = boundValuesBuilder.addRow();
+  for (size_t column = 0; column < variables.size(); ++column)
+  {
+    if (!params.Get(variables[column], row[column]))
+      row[column] = ScAddr();
+  }
+  return boundValuesBuilder.commitRow();
+}
+}  // namespace
+
 TemplateSearcherAbstract::TemplateSearcherAbstract(
     ScMemoryContext * context,
     ReplacementsUsingType replacementsUsingType,
     OutputStructureFillingType outputStructureFillingType)
   : context(context)
+  , templateCache(context)
+  , linksContentCache(context)
   , replacementsUsingType(replacementsUsingType)
   , outputStructureFillingType(outputStructureFillingType)
 {
 }
 
+void TemplateSearcherAbstract::copySettings(TemplateSearcherAbstract const & other)
+{
+  inputStructures = other.inputStructures;
+  replacementsUsingType = other.replacementsUsingType;
+  outputStructureFillingType = other.outputStructureFillingType;
+  atomicLogicalFormulaSearchBeforeGenerationType = other.atomicLogicalFormulaSearchBeforeGenerationType;
+}
+
+void TemplateSearcherAbstract::onStructureElementAdded(ScAddr const & structure, ScAddr const & element)
+{
+  for (TaskSearcher const & taskSearcher : taskSearchers)
+    taskSearcher.searcher->onStructureElementAdded(structure, element);
+}
+
 void TemplateSearcherAbstract::setInputStructures(ScAddrVector const & otherInputStructures)
 {
   inputStructures = otherInputStructures;
@@ -30,35 +69,169 @@ ScAddrVector TemplateSearcherAbstract::getInputStructures() const
   return inputStructures;
 }
 
+void TemplateSearcherAbstract::searchTemplate(
+    ScAddr const & templateAddr,
+    ScTemplateParams const & templateParams,
+    ScAddrHashSet const & variables,
+    Replacements & result)
+{
+  searchTemplate(templateAddr, templateParams, variables, result, [this](Replacements &) {
+    return replacementsUsingType != ReplacementsUsingType::REPLACEMENTS_FIRST;
+  });
+}
+
 void TemplateSearcherAbstract::searchTemplate(
     ScAddr const & templateAddr,
     vector<ScTemplateParams> const & scTemplateParamsVector,
     ScAddrHashSet const & variables,
     Replacements & result)
 {
-  Replacements searchResults;
-  ScAddrVector variableReplacementValues;
-  ScAddr argument;
+  prepareResult(variables, result);
+  Replacements boundValues(result.getVariables());
+  ReplacementsBuilder boundValuesBuilder(boundValues);
+  std::vector<ScTemplateParams const *> groupsParams;
+  for (ScTemplateParams const & scTemplateParams : scTemplateParamsVector)
+  {
+    if (addParamsGroup(scTemplateParams, boundValuesBuilder))
+      groupsParams.push_back(&scTemplateParams);
+  }
+
+  ThreadPool const & pool = threadPool ? *threadPool : ThreadPool::getShared();
+  if (groupsParams.size() >= PARALLEL_SEARCH_MIN_PARAMS_AMOUNT && pool.getThreadsAmount() > 1)
+  {
+    searchTemplateInParallel(templateAddr, groupsParams, variables, result);
+    return;
+  }
+  for (ScTemplateParams const * scTemplateParams : groupsParams)
+    searchTemplate(templateAddr, *scTemplateParams, variables, result);
+}
+
+void TemplateSearcherAbstract::searchTemplateInParallel(
+    ScAddr const & templateAddr,
+    std::vector<ScTemplateParams const *> const & groupsParams,
+    ScAddrHashSet const & variables,
+    Replacements & result)
+{
+  ThreadPool & pool = threadPool ? *threadPool : ThreadPool::getShared();
+  size_t const tasksAmount = std::min(pool.getThreadsAmount(), groupsParams.size());
+  // memory contexts are not shared between threads, so each task searches by a clone with own context
+  while (taskSearchers.size() < tasksAmount)
+  {
+    TaskSearcher & taskSearcher = taskSearchers.emplace_back();
+    taskSearcher.context = std::make_unique<ScMemoryContext>(sc_access_lvl_make_min, "inference_template_search");
+    taskSearcher.searcher = clone(taskSearcher.context.get());
+  }
+  for (size_t task = 0; task < tasksAmount; ++task)
+    taskSearchers[task].searcher->copySettings(*this);
+
+  ScAddrVector const & resultVariables = result.getVariables();
+  // rows found by tasks are accounted in the memory budget of the arena of this thread
+  SharedInferenceArena const sharedArena;
+  // each task searches consecutive params, so rows found by all tasks are added in order of params
+  std::vector<Replacements> tasksResults(tasksAmount);
+  pool.run(tasksAmount, [&](size_t task) {
+    SharedInferenceArena::TaskScope const taskScope(sharedArena);
+    TemplateSearcherAbstract & searcher = *taskSearchers[task].searcher;
+    Replacements taskResult(resultVariables);
+    size_t const paramsEnd = (task + 1) * groupsParams.size() / tasksAmount;
+    for (size_t params = task * groupsParams.size() / tasksAmount; params < paramsEnd; ++params)
+      searcher.searchTemplate(templateAddr, *groupsParams[params], variables, taskResult);
+    tasksResults[task] = std::move(taskResult);
+  });
+
+  size_t resultRowsAmount = result.getRowsAmount();
+  for (Replacements const & taskResult : tasksResults)
+    resultRowsAmount += taskResult.getRowsAmount();
+  result.reserve(resultRowsAmount);
+  for (Replacements const & taskResult : tasksResults)
+  {
+    for (Replacements::Row const & row : taskResult)
+      result.addRow(row);
+  }
+}
 
+void TemplateSearcherAbstract::searchTemplate(
+    ScAddr const & templateAddr,
+    vector<ScTemplateParams> const & scTemplateParamsVector,
+    ScAddrHashSet const & variables,
+    Replacements & result,
+    ReplacementsConsumer const & consumer)
+{
+  prepareResult(variables, result);
+  bool isStopped = false;
+  ReplacementsConsumer const & paramsConsumer = [&consumer, &isStopped](Replacements & paramsResult) {
+    isStopped = !consumer(paramsResult);
+    return !isStopped;
+  };
+  Replacements boundValues(result.getVariables());
+  ReplacementsBuilder boundValuesBuilder(boundValues);
   for (ScTemplateParams const & scTemplateParams : scTemplateParamsVector)
   {
-    searchTemplate(templateAddr, scTemplateParams, variables, searchResults);
-    for (ScAddr const & variable : variables)
-    {
-      if (searchResults.count(variable))
-      {
-        variableReplacementValues = searchResults.at(variable);
-        if (scTemplateParams.Get(variable, argument))
-        {
-          result[variable].push_back(argument);
-        }
-        else if (!variableReplacementValues.empty())
-        {
-          result[variable] = variableReplacementValues;
-        }
-      }
-    }
+    if (!addParamsGroup(scTemplateParams, boundValuesBuilder))
+      continue;
+    searchTemplate(templateAddr, scTemplateParams, variables, result, paramsConsumer);
+    if (isStopped)
+      return;
+  }
+}
+
+void TemplateSearcherAbstract::searchTemplate(
+    ScAddr const & templateAddr,
+    TemplateParamsCursor & cursor,
+    ScAddrHashSet const & variables,
+    Replacements & result)
+{
+  prepareResult(variables, result);
+  Replacements boundValues(result.getVariables());
+  ReplacementsBuilder boundValuesBuilder(boundValues);
+  while (cursor.next())
+  {
+    if (addParamsGroup(cursor.getParams(), boundValuesBuilder))
+      searchTemplate(templateAddr, cursor.getParams(), variables, result);
+  }
+}
+
+void TemplateSearcherAbstract::searchTemplate(
+    ScAddr const & templateAddr,
+    TemplateParamsCursor & cursor,
+    ScAddrHashSet const & variables,
+    Replacements & result,
+    ReplacementsConsumer const & consumer)
+{
+  prepareResult(variables, result);
+  bool isStopped = false;
+  ReplacementsConsumer const & paramsConsumer = [&consumer, &isStopped](Replacements & paramsResult) {
+    isStopped = !consumer(paramsResult);
+    return !isStopped;
+  };
+  Replacements boundValues(result.getVariables());
+  ReplacementsBuilder boundValuesBuilder(boundValues);
+  while (!isStopped && cursor.next())
+  {
+    if (addParamsGroup(cursor.getParams(), boundValuesBuilder))
+      searchTemplate(templateAddr, cursor.getParams(), variables, result, paramsConsumer);
+  }
+}
+
+void TemplateSearcherAbstract::prepareResult(ScAddrHashSet const & variables, Replacements & result)
+{
+  if (result.getColumnsAmount() == 0)
+    result = Replacements(variables);
+}
+
+bool TemplateSearcherAbstract::addResultItem(
+    ScTemplateSearchResultItem const & item,
+    ScTemplateParams const & templateParams,
+    ReplacementsBuilder & resultBuilder)
+{
+  ScAddrVector const & variables = resultBuilder.getVariables();
+  ScAddr * row = resultBuilder.addRow();
+  for (size_t column = 0; column < variables.size(); ++column)
+  {
+    if (!item.Get(variables[column], row[column]))
+      templateParams.Get(variables[column], row[column]);
   }
+  return resultBuilder.commitRow();
 }
 
 void TemplateSearcherAbstract::getVariables(ScAddr const & formula, ScAddrHashSet & variables)
@@ -81,19 +254,61 @@ bool TemplateSearcherAbstract::isContentIdentical(
     ScTemplateSearchResultItem const & item,
     std::map<std::string, std::string> const & linksContentMap)
 {
-  bool result = true;
   ScAddr link;
-  std::string linkContent;
   for (auto const & contentMap : linksContentMap)
   {
-    item.Get(contentMap.first, link);
-    context->GetLinkContent(link, linkContent);
-    if (contentMap.second != linkContent)
+    // constant links of the template are absent in item and have the content of the template
+    if (item.Get(contentMap.first, link) && !linksContentCache.hasContent(link, contentMap.second))
+      return false;
+  }
+
+  return true;
+}
+
+std::map<std::string, std::string> const & TemplateSearcherAbstract::getCachedTemplateLinksContent(
+    ScAddr const & templateAddr)
+{
+  auto const & found = templatesLinksContent.find(templateAddr);
+  if (found != templatesLinksContent.cend())
+    return found->second;
+  return templatesLinksContent.emplace(templateAddr, getTemplateLinksContent(templateAddr)).first->second;
+}
+
+std::vector<ScTemplateParams> TemplateSearcherAbstract::getParamsSeededByContent(
+    ScTemplateParams const & templateParams,
+    std::map<std::string, std::string> const & linksContentMap,
+    std::function<bool(ScAddr const &)> const & isLinkValid)
+{
+  std::string const * seedAlias = nullptr;
+  ScAddrVector seedLinks;
+  ScAddr boundLink;
+  for (auto const & contentMap : linksContentMap)
+  {
+    if (contentMap.second.empty() || templateParams.Get(contentMap.first, boundLink))
+      continue;
+
+    ScAddrVector candidateLinks;
+    for (ScAddr const & link : linksContentCache.getLinksByContent(contentMap.second))
     {
-      result = false;
-      break;
+      if (!isLinkValid || isLinkValid(link))
+        candidateLinks.push_back(link);
+    }
+    if (seedAlias == nullptr || candidateLinks.size() < seedLinks.size())
+    {
+      seedAlias = &contentMap.first;
+      seedLinks = std::move(candidateLinks);
     }
   }
 
-  return result;
+  if (seedAlias == nullptr)
+    return {templateParams};
+
+  std::vector<ScTemplateParams> seededParams;
+  seededParams.reserve(seedLinks.size());
+  for (ScAddr const & link : seedLinks)
+  {
+    ScTemplateParams & params = seededParams.emplace_back(templateParams);
+    params.Add(*seedAlias, link);
+  }
+  return seededParams;
 }
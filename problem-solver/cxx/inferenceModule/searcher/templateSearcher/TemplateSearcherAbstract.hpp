@@ -8,6 +8,8 @@
 
 #include <vector>
 #include <algorithm>
+#include <functional>
+#include <unordered_map>
 
 #include "sc-memory/sc_memory.hpp"
 #include "sc-memory/sc_addr.hpp"
@@ -16,10 +18,22 @@
 
 #include "inferenceConfig/InferenceConfig.hpp"
 
+#include "utils/LinksContentCache.hpp"
+#include "utils/ReplacementsBuilder.hpp"
 #include "utils/ReplacementsUtils.hpp"
+#include "utils/TemplateCache.hpp"
+#include "utils/TemplateParamsCursor.hpp"
 
 namespace inference
 {
+class ThreadPool;
+
+/**
+ * @brief Consumer of search result rows. It is called after each row is added to the search result and may take
+ * and remove rows of the result, the search stops when it returns false
+ */
+using ReplacementsConsumer = std::function<bool(Replacements & result)>;
+
 /// Class to search atomic logical formulas and get replacements
 class TemplateSearcherAbstract
 {
@@ -31,19 +45,92 @@ public:
 
   virtual ~TemplateSearcherAbstract() = default;
 
+  /// @returns searcher of the same type and settings which uses the other memory context, so it may search in other
+  /// thread
+  virtual std::unique_ptr<TemplateSearcherAbstract> clone(ScMemoryContext * otherContext) const = 0;
+
+  /// Minimal amount of params groups searched in parallel by searchers in other threads
+  static size_t constexpr PARALLEL_SEARCH_MIN_PARAMS_AMOUNT = 64;
+
   // TODO(MksmOrlov): implement searcher with default search template, configure searcher to use smart search or default
+  /// Search template and add all found rows to the result, only the first row is added if REPLACEMENTS_FIRST is used
+  void searchTemplate(
+      ScAddr const & templateAddr,
+      ScTemplateParams const & templateParams,
+      ScAddrHashSet const & variables,
+      Replacements & result);
+
+  /// Search template and pass found rows to the consumer as soon as they are found
   virtual void searchTemplate(
       ScAddr const & templateAddr,
       ScTemplateParams const & templateParams,
       ScAddrHashSet const & variables,
-      Replacements & result) = 0;
+      Replacements & result,
+      ReplacementsConsumer const & consumer) = 0;
 
+  /// Search template with each params and add found rows to the result. Params binding the same values to variables
+  /// form a group, the template is searched once for the group. Many groups are split between threads of the thread
+  /// pool and rows found by each thread are added in order of params
   virtual void searchTemplate(
       ScAddr const & templateAddr,
       vector<ScTemplateParams> const & scTemplateParamsVector,
       ScAddrHashSet const & variables,
       Replacements & result);
 
+  /// Search template with each params and pass found rows to the consumer, the search with rest params is skipped
+  /// when the consumer stops it
+  void searchTemplate(
+      ScAddr const & templateAddr,
+      vector<ScTemplateParams> const & scTemplateParamsVector,
+      ScAddrHashSet const & variables,
+      Replacements & result,
+      ReplacementsConsumer const & consumer);
+
+  /// Search template with params of each row of the cursor, params are filled row by row and grouped like params of
+  /// a vector
+  void searchTemplate(
+      ScAddr const & templateAddr,
+      TemplateParamsCursor & cursor,
+      ScAddrHashSet const & variables,
+      Replacements & result);
+
+  /// Search template with params of each row of the cursor and pass found rows to the consumer, rest rows are skipped
+  /// when the consumer stops the search
+  void searchTemplate(
+      ScAddr const & templateAddr,
+      TemplateParamsCursor & cursor,
+      ScAddrHashSet const & variables,
+      Replacements & result,
+      ReplacementsConsumer const & consumer);
+
+  /// Build template of the formula with params from triples of the formula cached by the searcher
+  bool buildTemplate(ScAddr const & templateAddr, ScTemplateParams const & templateParams, ScTemplate & result)
+  {
+    return templateCache.buildTemplate(templateAddr, templateParams, result);
+  }
+
+  /// Called after inference adds the element to the structure, so searchers checking membership in structures find it
+  /// without waiting for the sc-event about the added edge
+  virtual void onStructureElementAdded(ScAddr const & structure, ScAddr const & element);
+
+  /// Set thread pool to search many params groups in parallel, the shared thread pool is used by default
+  void setThreadPool(ThreadPool & otherThreadPool)
+  {
+    threadPool = &otherThreadPool;
+  }
+
+  /// @returns amount of clones of the searcher kept to search params groups in parallel
+  size_t getTaskSearchersAmount() const
+  {
+    return taskSearchers.size();
+  }
+
+  /// @returns cache of triples of formulas read by the searcher
+  TemplateCache const & getTemplateCache() const
+  {
+    return templateCache;
+  }
+
   void getVariables(ScAddr const & formula, ScAddrHashSet & variables);
 
   void getConstants(ScAddr const & formula, ScAddrHashSet & constants);
@@ -88,20 +175,71 @@ public:
   }
 
 protected:
+  /// Copy input structures and settings of the other searcher
+  void copySettings(TemplateSearcherAbstract const & other);
+
+  /// Initialize result columns with variables if result has no columns yet
+  static void prepareResult(ScAddrHashSet const & variables, Replacements & result);
+
+  /**
+   * @brief Add result row with values from search result item, values absent in item are taken from template params.
+   * Items which differ only in values of variables absent in result are added once
+   * @returns true if the row is added, false if the builder has added the same row before
+   */
+  static bool addResultItem(
+      ScTemplateSearchResultItem const & item,
+      ScTemplateParams const & templateParams,
+      ReplacementsBuilder & resultBuilder);
+
+  /// Get contents of links of the template read once per template by the searcher
+  std::map<std::string, std::string> const & getCachedTemplateLinksContent(ScAddr const & templateAddr);
+
+  /**
+   * @brief Get params to search the template starting from links with the same content as a link of the template.
+   * A link variable absent in template params with the least amount of candidate links is bound to each candidate
+   * found by the content index of sc-memory and accepted by the filter
+   * @returns template params if no link variable can be bound, empty vector if the link variable has no candidates
+   */
+  std::vector<ScTemplateParams> getParamsSeededByContent(
+      ScTemplateParams const & templateParams,
+      std::map<std::string, std::string> const & linksContentMap,
+      std::function<bool(ScAddr const &)> const & isLinkValid = {});
 
   ScMemoryContext * context;
+  TemplateCache templateCache;
+  LinksContentCache linksContentCache;
+  std::unordered_map<ScAddr, std::map<std::string, std::string>, ScAddrHashFunc<uint32_t>> templatesLinksContent;
   std::unique_ptr<ScTemplateSearchResult> searchWithoutContentResult;
   ScAddrVector inputStructures;
   ReplacementsUsingType replacementsUsingType;
   OutputStructureFillingType outputStructureFillingType;
-  AtomicLogicalFormulaSearchBeforeGenerationType atomicLogicalFormulaSearchBeforeGenerationType;
+  AtomicLogicalFormulaSearchBeforeGenerationType atomicLogicalFormulaSearchBeforeGenerationType =
+      SEARCH_WITH_REPLACEMENTS;
 
 private:
+  /// Clone of the searcher with own memory context which searches params groups of one task of a parallel search
+  struct TaskSearcher
+  {
+    std::unique_ptr<ScMemoryContext> context;
+    std::unique_ptr<TemplateSearcherAbstract> searcher;
+  };
+
+  /// Clones are kept between searches, so their templates, indices and contents of links are read once
+  std::vector<TaskSearcher> taskSearchers;
+  ThreadPool * threadPool = nullptr;
+
+  /// Search template with params of each group by clones of the searcher with own memory contexts in parallel
+  void searchTemplateInParallel(
+      ScAddr const & templateAddr,
+      std::vector<ScTemplateParams const *> const & groupsParams,
+      ScAddrHashSet const & variables,
+      Replacements & result);
+
   virtual void searchTemplateWithContent(
-      ScTemplate const & searchTemplate,
       ScAddr const & templateAddr,
       ScTemplateParams const & templateParams,
-      Replacements & result) = 0;
+      Replacements & result,
+      ReplacementsConsumer const & consumer) = 0;
 
   virtual std::map<std::string, std::string> getTemplateLinksContent(ScAddr const & templateAddr) = 0;
 };
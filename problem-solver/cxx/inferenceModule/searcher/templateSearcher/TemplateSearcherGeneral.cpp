@@ -21,39 +21,40 @@ TemplateSearcherGeneral::TemplateSearcherGeneral(ScMemoryContext * context)
 {
 }
 
+std::unique_ptr<TemplateSearcherAbstract> TemplateSearcherGeneral::clone(ScMemoryContext * otherContext) const
+{
+  auto searcher = std::make_unique<TemplateSearcherGeneral>(otherContext);
+  searcher->copySettings(*this);
+  return searcher;
+}
+
 void TemplateSearcherGeneral::searchTemplate(
     ScAddr const & templateAddr,
     ScTemplateParams const & templateParams,
     ScAddrHashSet const & variables,
-    Replacements & result)
+    Replacements & result,
+    ReplacementsConsumer const & consumer)
 {
   ScTemplate searchTemplate;
-  if (context->HelperBuildTemplate(searchTemplate, templateAddr, templateParams))
+  if (buildTemplate(templateAddr, templateParams, searchTemplate))
   {
+    prepareResult(variables, result);
     if (context->HelperCheckEdge(
             InferenceKeynodes::concept_template_with_links, templateAddr, ScType::EdgeAccessConstPosPerm))
     {
-      searchTemplateWithContent(searchTemplate, templateAddr, templateParams, result);
+      searchTemplateWithContent(templateAddr, templateParams, result, consumer);
     }
     else
     {
+      ReplacementsBuilder resultBuilder(result);
       context->HelperSmartSearchTemplate(
           searchTemplate,
-          [&templateParams, &result, &variables, this](
+          [&templateParams, &resultBuilder, &result, &consumer](
               ScTemplateSearchResultItem const & item) -> ScTemplateSearchRequest {
-            // Add search result items to the result Replacements
-            for (ScAddr const & variable : variables)
-            {
-              ScAddr argument;
-              if (item.Get(variable, argument) || templateParams.Get(variable, argument))
-              {
-                result[variable].push_back(argument);
-              }
-            }
-            if (replacementsUsingType == ReplacementsUsingType::REPLACEMENTS_FIRST)
-              return ScTemplateSearchRequest::STOP;
-            else
+            // Add search result items to the result Replacements, duplicate rows are not passed to the consumer
+            if (!addResultItem(item, templateParams, resultBuilder))
               return ScTemplateSearchRequest::CONTINUE;
+            return consumer(result) ? ScTemplateSearchRequest::CONTINUE : ScTemplateSearchRequest::STOP;
           });
     }
   }
@@ -64,37 +65,42 @@ void TemplateSearcherGeneral::searchTemplate(
 }
 
 void TemplateSearcherGeneral::searchTemplateWithContent(
-    ScTemplate const & searchTemplate,
     ScAddr const & templateAddr,
     ScTemplateParams const & templateParams,
-    Replacements & result)
+    Replacements & result,
+    ReplacementsConsumer const & consumer)
 {
-  std::map<std::string, std::string> linksContentMap = getTemplateLinksContent(templateAddr);
+  std::map<std::string, std::string> const & linksContentMap = getCachedTemplateLinksContent(templateAddr);
   ScAddrHashSet variables;
   getVariables(templateAddr, variables);
+  prepareResult(variables, result);
 
-  context->HelperSmartSearchTemplate(
-      searchTemplate,
-      [templateParams, &result, &variables](ScTemplateSearchResultItem const & item) -> ScTemplateSearchRequest {
-        // Add search result items to the result Replacements
-        for (ScAddr const & variable : variables)
-        {
-          ScAddr argument;
-          if (item.Has(variable))
-          {
-            result[variable].push_back(item[variable]);
-          }
-          if (templateParams.Get(variable, argument))
-          {
-            result[variable].push_back(argument);
-          }
-        }
-        return ScTemplateSearchRequest::STOP;
-      },
-      [&linksContentMap, this](ScTemplateSearchResultItem const & item) -> bool {
-        // Filter result item by the same content
-        return isContentIdentical(item, linksContentMap);
-      });
+  ReplacementsBuilder resultBuilder(result);
+  bool isFound = false;
+  // Search starts from links found by content instead of checking content of links of all found items
+  for (ScTemplateParams const & seededParams : getParamsSeededByContent(templateParams, linksContentMap))
+  {
+    ScTemplate searchTemplate;
+    if (!buildTemplate(templateAddr, seededParams, searchTemplate))
+      continue;
+
+    context->HelperSmartSearchTemplate(
+        searchTemplate,
+        [&seededParams, &resultBuilder, &result, &consumer, &isFound](
+            ScTemplateSearchResultItem const & item) -> ScTemplateSearchRequest {
+          // Add search result items to the result Replacements
+          addResultItem(item, seededParams, resultBuilder);
+          consumer(result);
+          isFound = true;
+          return ScTemplateSearchRequest::STOP;
+        },
+        [&linksContentMap, this](ScTemplateSearchResultItem const & item) -> bool {
+          // Filter result item by the same content
+          return isContentIdentical(item, linksContentMap);
+        });
+    if (isFound)
+      break;
+  }
 }
 
 std::map<std::string, std::string> TemplateSearcherGeneral::getTemplateLinksContent(ScAddr const & templateAddr)
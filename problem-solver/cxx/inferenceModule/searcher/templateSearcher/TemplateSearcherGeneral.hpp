@@ -22,18 +22,23 @@ class TemplateSearcherGeneral : public TemplateSearcherAbstract
 public:
   explicit TemplateSearcherGeneral(ScMemoryContext * ms_context);
 
+  std::unique_ptr<TemplateSearcherAbstract> clone(ScMemoryContext * otherContext) const override;
+
+  using TemplateSearcherAbstract::searchTemplate;
+
   void searchTemplate(
       ScAddr const & templateAddr,
       ScTemplateParams const & templateParams,
       ScAddrHashSet const & variables,
-      Replacements & result) override;
+      Replacements & result,
+      ReplacementsConsumer const & consumer) override;
 
 private:
   void searchTemplateWithContent(
-      ScTemplate const & searchTemplate,
       ScAddr const & templateAddr,
       ScTemplateParams const & templateParams,
-      Replacements & result) override;
+      Replacements & result,
+      ReplacementsConsumer const & consumer) override;
 
   std::map<std::string, std::string> getTemplateLinksContent(ScAddr const & templateAddr) override;
 };
@@ -10,7 +10,6 @@
 #include <algorithm>
 
 #include "sc-agents-common/utils/CommonUtils.hpp"
-#include "sc-agents-common/utils/IteratorUtils.hpp"
 
 #include "keynodes/InferenceKeynodes.hpp"
 
@@ -21,7 +20,6 @@ TemplateSearcherInStructures::TemplateSearcherInStructures(
     ScAddrVector const & otherInputStructures)
   : TemplateSearcherAbstract(context)
 {
-  this->contentOfAllInputStructures = std::make_unique<ScAddrHashSet>();
   inputStructures = otherInputStructures;
 }
 
@@ -30,45 +28,49 @@ TemplateSearcherInStructures::TemplateSearcherInStructures(ScMemoryContext * con
 {
 }
 
+std::unique_ptr<TemplateSearcherAbstract> TemplateSearcherInStructures::clone(ScMemoryContext * otherContext) const
+{
+  auto searcher = std::make_unique<TemplateSearcherInStructures>(otherContext);
+  searcher->copySettings(*this);
+  return searcher;
+}
+
+void TemplateSearcherInStructures::onStructureElementAdded(ScAddr const & structure, ScAddr const & element)
+{
+  TemplateSearcherAbstract::onStructureElementAdded(structure, element);
+  if (inputStructuresIndex)
+    inputStructuresIndex->addElement(structure, element);
+}
+
 void TemplateSearcherInStructures::searchTemplate(
     ScAddr const & templateAddr,
     ScTemplateParams const & templateParams,
     ScAddrHashSet const & variables,
-    Replacements & result)
+    Replacements & result,
+    ReplacementsConsumer const & consumer)
 {
   searchWithoutContentResult = std::make_unique<ScTemplateSearchResult>();
   ScTemplate searchTemplate;
-  if (context->HelperBuildTemplate(searchTemplate, templateAddr, templateParams))
+  if (buildTemplate(templateAddr, templateParams, searchTemplate))
   {
     prepareBeforeSearch();
+    prepareResult(variables, result);
     if (context->HelperCheckEdge(
             InferenceKeynodes::concept_template_with_links, templateAddr, ScType::EdgeAccessConstPosPerm))
     {
-      searchTemplateWithContent(searchTemplate, templateAddr, templateParams, result);
+      searchTemplateWithContent(templateAddr, templateParams, result, consumer);
     }
     else
     {
+      ReplacementsBuilder resultBuilder(result);
       context->HelperSmartSearchTemplate(
           searchTemplate,
-          [templateParams, &result, &variables, this](
+          [&templateParams, &resultBuilder, &result, &consumer](
               ScTemplateSearchResultItem const & item) -> ScTemplateSearchRequest {
-            // Add search result item to the answer container
-            ScAddr argument;
-            for (ScAddr const & variable : variables)
-            {
-              if (item.Has(variable))
-              {
-                result[variable].push_back(item[variable]);
-              }
-              else if (templateParams.Get(variable, argument))
-              {
-                result[variable].push_back(argument);
-              }
-            }
-            if (replacementsUsingType == ReplacementsUsingType::REPLACEMENTS_FIRST)
-              return ScTemplateSearchRequest::STOP;
-            else
+            // Add search result item to the answer container, duplicate rows are not passed to the consumer
+            if (!addResultItem(item, templateParams, resultBuilder))
               return ScTemplateSearchRequest::CONTINUE;
+            return consumer(result) ? ScTemplateSearchRequest::CONTINUE : ScTemplateSearchRequest::STOP;
           },
           [this](ScAddr const & item) -> bool {
             // Filter result item belonging to any of the input structures
@@ -83,44 +85,55 @@ void TemplateSearcherInStructures::searchTemplate(
 }
 
 void TemplateSearcherInStructures::searchTemplateWithContent(
-    ScTemplate const & searchTemplate,
     ScAddr const & templateAddr,
     ScTemplateParams const & templateParams,
-    Replacements & result)
+    Replacements & result,
+    ReplacementsConsumer const & consumer)
 {
   ScAddrHashSet variables;
   getVariables(templateAddr, variables);
+  prepareResult(variables, result);
+  // Links of the template are taken by membership in the input structures, so they are not cached between searches
   std::map<std::string, std::string> linksContentMap = getTemplateLinksContent(templateAddr);
 
-  context->HelperSearchTemplate(
-      searchTemplate,
-      [templateParams, &result, &variables, this](ScTemplateSearchResultItem const & item) -> ScTemplateSearchRequest {
-        // Add search result item to the answer container
-        for (ScAddr const & variable : variables)
-        {
-          ScAddr argument;
-          if (item.Get(variable, argument) || templateParams.Get(variable, argument))
+  ReplacementsBuilder resultBuilder(result);
+  bool isStopped = false;
+  // Search starts from links of the input structures found by content
+  std::vector<ScTemplateParams> const seededParamsVector =
+      getParamsSeededByContent(templateParams, linksContentMap, [this](ScAddr const & link) -> bool {
+        return isValidElement(link);
+      });
+  for (ScTemplateParams const & seededParams : seededParamsVector)
+  {
+    ScTemplate searchTemplate;
+    if (!buildTemplate(templateAddr, seededParams, searchTemplate))
+      continue;
+
+    context->HelperSearchTemplate(
+        searchTemplate,
+        [&seededParams, &resultBuilder, &result, &consumer, &isStopped](
+            ScTemplateSearchResultItem const & item) -> ScTemplateSearchRequest {
+          // Add search result item to the answer container, duplicate rows are not passed to the consumer
+          if (!addResultItem(item, seededParams, resultBuilder))
+            return ScTemplateSearchRequest::CONTINUE;
+          isStopped = !consumer(result);
+          return isStopped ? ScTemplateSearchRequest::STOP : ScTemplateSearchRequest::CONTINUE;
+        },
+        [&linksContentMap, this](ScTemplateSearchResultItem const & item) -> bool {
+          // Filter result item by the same content and belonging to any of the input structures
+          if (!isContentIdentical(item, linksContentMap))
+            return false;
+          for (size_t i = 0; i < item.Size(); i++)
           {
-            result[variable].push_back(argument);
+            ScAddr const & checkedElement = item[i];
+            if (isValidElement(checkedElement) == SC_FALSE)
+              return false;
           }
-        }
-        if (replacementsUsingType == ReplacementsUsingType::REPLACEMENTS_FIRST)
-          return ScTemplateSearchRequest::STOP;
-        else
-          return ScTemplateSearchRequest::CONTINUE;
-      },
-      [&linksContentMap, this](ScTemplateSearchResultItem const & item) -> bool {
-        // Filter result item by the same content and belonging to any of the input structures
-        if (!isContentIdentical(item, linksContentMap))
-          return false;
-        for (size_t i = 0; i < item.Size(); i++)
-        {
-          ScAddr const & checkedElement = item[i];
-          if (isValidElement(checkedElement) == SC_FALSE)
-            return false;
-        }
-        return true;
-      });
+          return true;
+        });
+    if (isStopped)
+      break;
+  }
 }
 
 std::map<std::string, std::string> TemplateSearcherInStructures::getTemplateLinksContent(ScAddr const & templateAddr)
@@ -144,25 +157,20 @@ std::map<std::string, std::string> TemplateSearcherInStructures::getTemplateLink
 
 void TemplateSearcherInStructures::prepareBeforeSearch()
 {
-  this->contentOfAllInputStructures->clear();
-  if (replacementsUsingType == REPLACEMENTS_ALL)
+  if (!inputStructuresIndex || inputStructuresIndex->getStructures() != inputStructures)
   {
-    SC_LOG_DEBUG("start input structures processing");
-    for (auto const & inputStructure : inputStructures)
-    {
-      ScAddrVector const & elements = utils::IteratorUtils::getAllWithType(context, inputStructure, ScType::Unknown);
-      contentOfAllInputStructures->insert(elements.cbegin(), elements.cend());
-    }
-    SC_LOG_DEBUG("input structures processed, found " << contentOfAllInputStructures->size() << " elements");
+    inputStructuresIndex =
+        std::make_unique<StructuresMembershipIndex>(context, inputStructures, getIndexedElementType());
   }
+  inputStructuresIndex->update();
+}
+
+ScType TemplateSearcherInStructures::getIndexedElementType() const
+{
+  return ScType::Unknown;
 }
 
 bool TemplateSearcherInStructures::isValidElement(ScAddr const & element) const
 {
-  if (replacementsUsingType == REPLACEMENTS_FIRST)
-    return std::any_of(inputStructures.cbegin(), inputStructures.cend(), [&element, this](ScAddr const &inputStructure){
-      return context->HelperCheckEdge(inputStructure, element, ScType::EdgeAccessConstPosPerm);
-    });
-  else
-    return contentOfAllInputStructures->count(element);
+  return inputStructuresIndex->contains(element);
 }
@@ -13,6 +13,7 @@
 #include "sc-memory/sc_addr.hpp"
 
 #include "utils/ReplacementsUtils.hpp"
+#include "utils/StructuresMembershipIndex.hpp"
 #include "TemplateSearcherAbstract.hpp"
 
 namespace inference
@@ -24,21 +25,33 @@ public:
 
   explicit TemplateSearcherInStructures(ScMemoryContext * ms_context);
 
+  std::unique_ptr<TemplateSearcherAbstract> clone(ScMemoryContext * otherContext) const override;
+
+  void onStructureElementAdded(ScAddr const & structure, ScAddr const & element) override;
+
+  using TemplateSearcherAbstract::searchTemplate;
+
   void searchTemplate(
       ScAddr const & templateAddr,
       ScTemplateParams const & templateParams,
       ScAddrHashSet const & variables,
-      Replacements & result) override;
+      Replacements & result,
+      ReplacementsConsumer const & consumer) override;
 
 protected:
-  std::unique_ptr<ScAddrHashSet> contentOfAllInputStructures;
+  /// Elements of input structures, it is created for the first search and kept up to date while input structures are
+  /// the same
+  std::unique_ptr<StructuresMembershipIndex> inputStructuresIndex;
+
+  /// @returns type of elements of input structures which membership is checked
+  virtual ScType getIndexedElementType() const;
 
 private:
   void searchTemplateWithContent(
-      ScTemplate const & searchTemplate,
       ScAddr const & templateAddr,
       ScTemplateParams const & templateParams,
-      Replacements & result) override;
+      Replacements & result,
+      ReplacementsConsumer const & consumer) override;
 
   std::map<std::string, std::string> getTemplateLinksContent(ScAddr const & templateAddr) override;
 
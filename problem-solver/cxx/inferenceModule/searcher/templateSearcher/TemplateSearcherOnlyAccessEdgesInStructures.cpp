@@ -6,8 +6,6 @@
 
 #include "keynodes/InferenceKeynodes.hpp"
 
-#include "sc-agents-common/utils/IteratorUtils.hpp"
-
 #include "TemplateSearcherOnlyAccessEdgesInStructures.hpp"
 
 namespace inference
@@ -25,6 +23,14 @@ TemplateSearcherOnlyAccessEdgesInStructures::TemplateSearcherOnlyAccessEdgesInSt
 {
 }
 
+std::unique_ptr<TemplateSearcherAbstract> TemplateSearcherOnlyAccessEdgesInStructures::clone(
+    ScMemoryContext * otherContext) const
+{
+  auto searcher = std::make_unique<TemplateSearcherOnlyAccessEdgesInStructures>(otherContext);
+  searcher->copySettings(*this);
+  return searcher;
+}
+
 map<std::string, std::string> TemplateSearcherOnlyAccessEdgesInStructures::getTemplateLinksContent(
     ScAddr const & templateAddr)
 {
@@ -33,31 +39,13 @@ map<std::string, std::string> TemplateSearcherOnlyAccessEdgesInStructures::getTe
   return {};
 }
 
-void TemplateSearcherOnlyAccessEdgesInStructures::prepareBeforeSearch()
+ScType TemplateSearcherOnlyAccessEdgesInStructures::getIndexedElementType() const
 {
-  this->contentOfAllInputStructures->clear();
-  if (replacementsUsingType == REPLACEMENTS_ALL)
-  {
-    SC_LOG_DEBUG("start input structures processing");
-    for (auto const & inputStructure : inputStructures)
-    {
-      ScAddrVector const & edges =
-          utils::IteratorUtils::getAllWithType(context, inputStructure, ScType::EdgeAccess);
-      contentOfAllInputStructures->insert(edges.cbegin(), edges.cend());
-    }
-    SC_LOG_DEBUG("input structures processed, found " << contentOfAllInputStructures->size() << " edges");
-  }
+  return ScType::EdgeAccess;
 }
 
 bool TemplateSearcherOnlyAccessEdgesInStructures::isValidElement(ScAddr const & element) const
 {
-  if (replacementsUsingType == REPLACEMENTS_ALL)
-    return !context->GetElementType(element).BitAnd(ScType::EdgeAccess) || contentOfAllInputStructures->count(element);
-  else
-    return !context->GetElementType(element).BitAnd(ScType::EdgeAccess) ||
-           std::any_of(
-               inputStructures.cbegin(), inputStructures.cend(), [&element, this](ScAddr const & inputStructure) {
-                 return context->HelperCheckEdge(inputStructure, element, ScType::EdgeAccessConstPosPerm);
-               });
+  return !context->GetElementType(element).BitAnd(ScType::EdgeAccess) || inputStructuresIndex->contains(element);
 }
 }  // namespace inference
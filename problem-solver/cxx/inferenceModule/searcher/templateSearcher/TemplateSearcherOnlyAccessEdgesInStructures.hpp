@@ -20,10 +20,12 @@ public:
 
   explicit TemplateSearcherOnlyAccessEdgesInStructures(ScMemoryContext * ms_context);
 
+  std::unique_ptr<TemplateSearcherAbstract> clone(ScMemoryContext * otherContext) const override;
+
 private:
   map<std::string, std::string> getTemplateLinksContent(ScAddr const & templateAddr) override;
 
-  void prepareBeforeSearch() override;
+  ScType getIndexedElementType() const override;
 
   bool isValidElement(ScAddr const & element) const override;
 };
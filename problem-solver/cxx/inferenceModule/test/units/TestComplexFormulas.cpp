@@ -167,6 +167,31 @@ TEST_F(InferenceComplexFormulasTest, TrueConjunctionImplicationFormula)
   context.Destroy();
 }
 
+// (!a && b) -> c
+TEST_F(InferenceComplexFormulasTest, TrueNegationConjunctionImplicationFormula)
+{
+  ScMemoryContext context(sc_access_lvl_make_min, "successful_inference");
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "negationConjunctionImplicationTest.scs");
+  initialize();
+
+  ScAddr action = context.HelperResolveSystemIdtf(QUESTION_IDENTIFIER);
+  EXPECT_TRUE(action.IsValid());
+
+  ScAddr argument = context.HelperFindBySystemIdtf(ARGUMENT_IDENTIFIER);
+  EXPECT_TRUE(argument.IsValid());
+
+  // Negation without replacements does not make the next atom of the conjunction false
+  EXPECT_TRUE(utils::AgentUtils::applyAction(&context, action, WAIT_TIME, InferenceKeynodes::action_direct_inference));
+  EXPECT_TRUE(context.HelperCheckEdge(
+      scAgentsCommon::CoreKeynodes::question_finished_successfully, action, ScType::EdgeAccessConstPosPerm));
+  EXPECT_TRUE(context.HelperCheckEdge(
+      context.HelperFindBySystemIdtf("target_class"), argument, ScType::EdgeAccessConstPosPerm));
+
+  shutdown();
+  context.Destroy();
+}
+
 // TODO (MksmOrlov): doesn't pass because of empty negation replacements
 // (!a) -> b
 TEST_F(InferenceComplexFormulasTest, DISABLED_TrueNegationImplicationLogicRule)
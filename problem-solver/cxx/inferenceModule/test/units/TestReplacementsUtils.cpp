@@ -0,0 +1,839 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "sc_test.hpp"
+
+#include "utils/InferenceArena.hpp"
+#include "utils/ReplacementsBloomFilter.hpp"
+#include "utils/ReplacementsBuilder.hpp"
+#include "utils/ReplacementsHashIndex.hpp"
+#include "utils/ReplacementsKernels.hpp"
+#include "utils/ReplacementsStreamingIntersection.hpp"
+#include "utils/ReplacementsUtils.hpp"
+#include "utils/TemplateParamsCursor.hpp"
+#include "utils/ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace inferenceTest
+{
+using ReplacementsUtilsTest = ScMemoryTest;
+
+bool hasRow(inference::Replacements const & replacements, ScAddrVector const & variables, ScAddrVector const & values)
+{
+  inference::Replacements::Projection const & projection = replacements.project(variables);
+  for (size_t row = 0; row < projection.getRowsAmount(); ++row)
+  {
+    bool isEqual = true;
+    for (size_t column = 0; column < projection.getColumnsAmount(); ++column)
+      isEqual &= projection.get(row, column) == values[column];
+    if (isEqual)
+      return true;
+  }
+  return false;
+}
+
+TEST_F(ReplacementsUtilsTest, ReplacementsTableRowsAndColumns)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddr const & a = context.CreateNode(ScType::NodeConst);
+  ScAddr const & b = context.CreateNode(ScType::NodeConst);
+
+  inference::Replacements replacements(ScAddrVector{x, y, x});
+  EXPECT_EQ(replacements.getColumnsAmount(), 2u);
+  EXPECT_TRUE(replacements.empty());
+
+  replacements.addRow({a, b});
+  replacements.addRow({b, a});
+  EXPECT_EQ(replacements.getRowsAmount(), 2u);
+  EXPECT_EQ(replacements.at(x)[1], b);
+  EXPECT_EQ(replacements.get(0, replacements.getColumnIndex(y)), b);
+  EXPECT_EQ(replacements.getColumnIndex(a), inference::Replacements::npos);
+
+  size_t rowsAmount = 0;
+  for (inference::Replacements::Row const & row : replacements)
+  {
+    EXPECT_EQ(row.getSize(), 2u);
+    ++rowsAmount;
+  }
+  EXPECT_EQ(rowsAmount, 2u);
+
+  inference::Replacements const & projection = replacements.projectWithout({x}).materialize();
+  EXPECT_EQ(projection.getVariables(), ScAddrVector{y});
+  EXPECT_EQ(projection.getRowsAmount(), 2u);
+  EXPECT_EQ(projection.at(y)[1], a);
+}
+
+TEST_F(ReplacementsUtilsTest, ReplacementsTableCopyOnWrite)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & a = context.CreateNode(ScType::NodeConst);
+  ScAddr const & b = context.CreateNode(ScType::NodeConst);
+
+  inference::Replacements replacements(ScAddrVector{x});
+  replacements.addRow({a});
+  inference::Replacements copy = replacements;
+  EXPECT_EQ(copy.getRow(0).begin(), replacements.getRow(0).begin());
+
+  copy.addRow({b});
+  EXPECT_EQ(copy.getRowsAmount(), 2u);
+  EXPECT_EQ(replacements.getRowsAmount(), 1u);
+  EXPECT_NE(copy.getRow(0).begin(), replacements.getRow(0).begin());
+  EXPECT_EQ(copy.get(0, 0), a);
+
+  inference::Replacements empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(empty.getColumnsAmount(), 0u);
+}
+
+TEST_F(ReplacementsUtilsTest, ReplacementsTableSharedByThreads)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 20; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  inference::Replacements replacements(ScAddrVector{x, y});
+  for (size_t i = 0; i < 10000; ++i)
+    replacements.addRow({values[i % 10], values[10 + i % 7]});
+  replacements.compress();
+  ASSERT_TRUE(replacements.isCompressed());
+
+  // threads read rows of the copy at once, rows are decoded once and both tables keep codes
+  inference::Replacements const copy = replacements;
+  inference::ThreadPool pool(4);
+  std::vector<char> isEqual(100, 0);
+  pool.run(isEqual.size(), [&copy, &values, &isEqual](size_t task) {
+    size_t const row = task * 100 + 99;
+    isEqual[task] = copy.get(row, 0) == values[row % 10] && copy.getRow(row)[1] == values[10 + row % 7];
+  });
+  EXPECT_EQ(std::count(isEqual.cbegin(), isEqual.cend(), 1), 100);
+  EXPECT_TRUE(copy.isCompressed());
+  EXPECT_TRUE(replacements.isCompressed());
+
+  // expanded table takes own rows, its copy keeps codes
+  inference::Replacements expanded = copy;
+  expanded.expand();
+  EXPECT_FALSE(expanded.isCompressed());
+  EXPECT_TRUE(copy.isCompressed());
+  EXPECT_EQ(expanded.getRowsAmount(), 10000u);
+  EXPECT_EQ(expanded.get(1234, 1), copy.get(1234, 1));
+}
+
+TEST_F(ReplacementsUtilsTest, ReplacementsInInferenceArena)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 10; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  {
+    inference::InferenceArena const arena;
+    EXPECT_NE(inference::InferenceArena::getMemoryResource(), std::pmr::get_default_resource());
+
+    inference::Replacements first(ScAddrVector{x});
+    inference::Replacements second(ScAddrVector{x, y});
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+      first.addRow({values[i]});
+      second.addRow({values[i / 2], values[i]});
+    }
+    inference::Replacements const & intersection = inference::ReplacementsUtils::intersectReplacements(first, second);
+    EXPECT_EQ(intersection.getRowsAmount(), values.size());
+    EXPECT_EQ(inference::ReplacementsUtils::subtractReplacements(first, second).getRowsAmount(), 5u);
+  }
+  EXPECT_EQ(inference::InferenceArena::getMemoryResource(), std::pmr::get_default_resource());
+}
+
+TEST_F(ReplacementsUtilsTest, SpillRowsBeyondMemoryBudget)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddr const & z = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 500; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  size_t const memoryBudget = 1 << 20;
+  inference::InferenceArena const arena(memoryBudget);
+  {
+    // rows of the first take 1.6 MB, so they do not fit the budget
+    inference::Replacements first(ScAddrVector{x, y});
+    inference::Replacements second(ScAddrVector{y, z});
+    for (size_t i = 0; i < 200000; ++i)
+      first.addRow({values[i % 500], values[i / 500]});
+    for (size_t i = 0; i < 400; ++i)
+      second.addRow({values[i], values[499 - i]});
+    EXPECT_TRUE(inference::InferenceArena::isSpilling());
+    EXPECT_GT(arena.getSpilledRowsMemorySize(), 0u);
+    EXPECT_LE(arena.getRowsMemorySize(), memoryBudget);
+    EXPECT_EQ(first.get(123456, 0), values[123456 % 500]);
+    EXPECT_EQ(first.get(123456, 1), values[123456 / 500]);
+
+    // spilled rows are joined partition by partition
+    inference::Replacements const & intersection = inference::ReplacementsUtils::intersectReplacements(first, second);
+    EXPECT_EQ(intersection.getRowsAmount(), 200000u);
+    EXPECT_TRUE(hasRow(intersection, {x, y, z}, {values[7], values[300], values[199]}));
+  }
+  EXPECT_EQ(arena.getSpilledRowsMemorySize(), 0u);
+  EXPECT_EQ(arena.getRowsMemorySize(), 0u);
+}
+
+TEST_F(ReplacementsUtilsTest, JoinHelpersInMemoryBudget)
+{
+  inference::InferenceArena const arena(1 << 20);
+  {
+    // words of the filter take 2 MB, so they are accounted as rows and do not fit the budget
+    inference::ReplacementsBloomFilter const filter(1 << 20);
+    EXPECT_GT(arena.getSpilledRowsMemorySize(), 0u);
+  }
+  EXPECT_EQ(arena.getSpilledRowsMemorySize(), 0u);
+  EXPECT_EQ(arena.getRowsMemorySize(), 0u);
+}
+
+TEST_F(ReplacementsUtilsTest, IntersectReplacementsByCommonVariable)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddr const & z = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 4; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  inference::Replacements first(ScAddrVector{x, y});
+  first.addRow({values[0], values[1]});
+  first.addRow({values[1], values[2]});
+  first.addRow({values[2], values[3]});
+  inference::Replacements second(ScAddrVector{z, y});
+  second.addRow({values[0], values[1]});
+  second.addRow({values[3], values[1]});
+  second.addRow({values[3], values[0]});
+
+  inference::Replacements const & result = inference::ReplacementsUtils::intersectReplacements(first, second);
+  EXPECT_EQ(result.getColumnsAmount(), 3u);
+  EXPECT_EQ(result.getRowsAmount(), 2u);
+  EXPECT_TRUE(hasRow(result, {x, y, z}, {values[0], values[1], values[0]}));
+  EXPECT_TRUE(hasRow(result, {x, y, z}, {values[0], values[1], values[3]}));
+}
+
+TEST_F(ReplacementsUtilsTest, IntersectReplacementsWithSmallerSecond)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddr const & z = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 20; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  inference::Replacements first(ScAddrVector{x, y});
+  for (size_t i = 0; i < values.size(); ++i)
+    first.addRow({values[i], values[i % 4]});
+  inference::Replacements second(ScAddrVector{y, x, z});
+  second.addRow({values[1], values[5], values[0]});
+  second.addRow({values[2], values[5], values[0]});
+  second.addRow({values[3], values[19], values[1]});
+
+  inference::Replacements const & result = inference::ReplacementsUtils::intersectReplacements(first, second);
+  EXPECT_EQ(result.getVariables(), (ScAddrVector{x, y, z}));
+  EXPECT_EQ(result.getRowsAmount(), 2u);
+  EXPECT_TRUE(hasRow(result, {x, y, z}, {values[5], values[1], values[0]}));
+  EXPECT_TRUE(hasRow(result, {x, y, z}, {values[19], values[3], values[1]}));
+}
+
+TEST_F(ReplacementsUtilsTest, IntersectReplacementsWithoutCommonVariables)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 4; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  inference::Replacements first(ScAddrVector{x});
+  first.addRow({values[0]});
+  first.addRow({values[1]});
+  inference::Replacements second(ScAddrVector{y});
+  second.addRow({values[2]});
+  second.addRow({values[3]});
+
+  inference::Replacements const & result = inference::ReplacementsUtils::intersectReplacements(first, second);
+  EXPECT_EQ(result.getRowsAmount(), 4u);
+  EXPECT_TRUE(hasRow(result, {x, y}, {values[0], values[2]}));
+  EXPECT_TRUE(hasRow(result, {x, y}, {values[1], values[3]}));
+}
+
+TEST_F(ReplacementsUtilsTest, IntersectReplacementsBySortMerge)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddr const & z = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 12; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  inference::Replacements first(ScAddrVector{x, y});
+  for (size_t i = values.size(); i-- > 0;)
+    first.addRow({values[i], values[i % 3]});
+  inference::Replacements second(ScAddrVector{y, z});
+  for (size_t i = 0; i < values.size(); ++i)
+    second.addRow({values[i % 2], values[i]});
+
+  inference::Replacements const & hashResult = inference::ReplacementsUtils::intersectReplacements(first, second);
+  inference::Replacements const & sortMergeResult =
+      inference::ReplacementsUtils::intersectReplacementsBySortMerge(first, second);
+  EXPECT_EQ(sortMergeResult.getVariables(), hashResult.getVariables());
+  EXPECT_EQ(sortMergeResult.getRowsAmount(), 48u);
+  EXPECT_EQ(sortMergeResult.getRowsAmount(), hashResult.getRowsAmount());
+  for (inference::Replacements::Row const & row : hashResult)
+    EXPECT_TRUE(hasRow(sortMergeResult, hashResult.getVariables(), ScAddrVector(row.begin(), row.end())));
+
+  EXPECT_FALSE(inference::ReplacementsUtils::isSortMergeIntersectionPreferred(first, second));
+}
+
+TEST_F(ReplacementsUtilsTest, IntersectReplacementsByGenericJoin)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddr const & z = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 12; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  // edges of a graph with triangles (i, i + 1, i + 2) for even i, each atom of the triangle pattern has all edges
+  ScAddrVector const variables = {x, y, z};
+  std::vector<inference::Replacements> edges;
+  for (size_t atom = 0; atom < 3; ++atom)
+  {
+    inference::Replacements & atomEdges = edges.emplace_back(ScAddrVector{variables[atom], variables[(atom + 1) % 3]});
+    for (size_t i = 0; i + 2 < values.size(); i += 2)
+    {
+      atomEdges.addRow({values[i], values[i + 1]});
+      atomEdges.addRow({values[i + 1], values[i + 2]});
+      atomEdges.addRow({values[i + 2], values[i]});
+      atomEdges.addRow({values[i], values[i + 1]});
+    }
+  }
+
+  inference::Replacements const & pairwiseResult = inference::ReplacementsUtils::intersectReplacements(
+      inference::ReplacementsUtils::intersectReplacements(edges[0], edges[1]), edges[2]);
+  inference::Replacements const & genericJoinResult =
+      inference::ReplacementsUtils::intersectReplacementsByGenericJoin(edges);
+  EXPECT_EQ(genericJoinResult.getColumnsAmount(), 3u);
+  EXPECT_EQ(genericJoinResult.getRowsAmount(), 15u);
+  EXPECT_EQ(genericJoinResult.getRowsAmount(), pairwiseResult.getRowsAmount());
+  for (inference::Replacements::Row const & row : pairwiseResult)
+    EXPECT_TRUE(hasRow(genericJoinResult, pairwiseResult.getVariables(), ScAddrVector(row.begin(), row.end())));
+
+  edges[1].truncate(0);
+  EXPECT_TRUE(inference::ReplacementsUtils::intersectReplacementsByGenericJoin(edges).empty());
+}
+
+TEST_F(ReplacementsUtilsTest, IntersectReplacementsWithStreamedRows)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddr const & z = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 4; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  inference::Replacements first(ScAddrVector{x, y});
+  first.addRow({values[0], values[1]});
+  first.addRow({values[1], values[2]});
+  first.addRow({values[2], values[3]});
+  inference::ReplacementsStreamingIntersection intersection(first);
+  EXPECT_TRUE(intersection.empty());
+
+  // each streamed row is removed right after it is joined, as template search consumers do
+  inference::Replacements streamed(ScAddrVector{z, y});
+  std::vector<ScAddrVector> const streamedRows = {
+      {values[0], values[1]}, {values[3], values[1]}, {values[3], values[0]}, {values[0], values[1]}};
+  for (ScAddrVector const & row : streamedRows)
+  {
+    streamed.addRow(row);
+    intersection.addRows(streamed);
+    streamed.truncate(0);
+  }
+  EXPECT_FALSE(intersection.empty());
+
+  inference::Replacements const & result = intersection.getResult();
+  EXPECT_EQ(result.getColumnsAmount(), 3u);
+  EXPECT_EQ(result.getRowsAmount(), 2u);
+  EXPECT_TRUE(hasRow(result, {x, y, z}, {values[0], values[1], values[0]}));
+  EXPECT_TRUE(hasRow(result, {x, y, z}, {values[0], values[1], values[3]}));
+}
+
+TEST_F(ReplacementsUtilsTest, SubtractReplacementsByCommonVariable)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 3; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  inference::Replacements first(ScAddrVector{x, y});
+  first.addRow({values[0], values[1]});
+  first.addRow({values[1], values[2]});
+  first.addRow({values[1], values[2]});
+  inference::Replacements second(ScAddrVector{y});
+  second.addRow({values[1]});
+
+  inference::Replacements const & result = inference::ReplacementsUtils::subtractReplacements(first, second);
+  EXPECT_EQ(result.getRowsAmount(), 1u);
+  EXPECT_TRUE(hasRow(result, {x, y}, {values[1], values[2]}));
+}
+
+TEST_F(ReplacementsUtilsTest, SubtractReplacementsWithMostRowsExisting)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddr const & z = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 100; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  inference::Replacements first(ScAddrVector{x, y});
+  inference::Replacements second(ScAddrVector{z, y, x});
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    first.addRow({values[i], values[(i + 1) % values.size()]});
+    if (i % 10 != 0)
+      second.addRow({values[0], values[(i + 1) % values.size()], values[i]});
+  }
+
+  inference::Replacements const & result = inference::ReplacementsUtils::subtractReplacements(first, second);
+  EXPECT_EQ(result.getVariables(), (ScAddrVector{x, y}));
+  EXPECT_EQ(result.getRowsAmount(), 10u);
+  for (size_t i = 0; i < values.size(); i += 10)
+    EXPECT_TRUE(hasRow(result, {x, y}, {values[i], values[i + 1]}));
+
+  EXPECT_EQ(
+      inference::ReplacementsUtils::subtractReplacements(first, inference::Replacements(ScAddrVector{x}))
+          .getRowsAmount(),
+      first.getRowsAmount());
+}
+
+TEST_F(ReplacementsUtilsTest, UniteReplacementsWithDifferentVariables)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 3; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  inference::Replacements first(ScAddrVector{x});
+  first.addRow({values[0]});
+  inference::Replacements second(ScAddrVector{y});
+  second.addRow({values[1]});
+  second.addRow({values[2]});
+
+  inference::Replacements const & result = inference::ReplacementsUtils::uniteReplacements(first, second);
+  EXPECT_EQ(result.getColumnsAmount(), 2u);
+  EXPECT_EQ(result.getRowsAmount(), 2u);
+  EXPECT_TRUE(hasRow(result, {x, y}, {values[0], values[1]}));
+  EXPECT_TRUE(hasRow(result, {x, y}, {values[0], values[2]}));
+}
+
+TEST_F(ReplacementsUtilsTest, UniteReplacementsRemovesDuplicates)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 3; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  inference::Replacements first(ScAddrVector{x, y});
+  for (size_t i = 0; i < 30; ++i)
+    first.addRow({values[i % 3], values[i % 2]});
+  inference::Replacements second(ScAddrVector{y});
+  for (size_t i = 0; i < 10; ++i)
+    second.addRow({values[i % 3]});
+
+  inference::Replacements const & result = inference::ReplacementsUtils::uniteReplacements(first, second);
+  EXPECT_EQ(result.getVariables(), (ScAddrVector{x, y}));
+  EXPECT_EQ(result.getRowsAmount(), 9u);
+  EXPECT_TRUE(hasRow(result, {x, y}, {values[0], values[0]}));
+  EXPECT_TRUE(hasRow(result, {x, y}, {values[2], values[1]}));
+  EXPECT_TRUE(hasRow(result, {x, y}, {values[1], values[2]}));
+  EXPECT_EQ(result.getRow(0)[0], values[0]);
+  EXPECT_EQ(result.getRow(0)[1], values[0]);
+  EXPECT_EQ(result.getRow(1)[0], values[1]);
+  EXPECT_EQ(result.getRow(1)[1], values[1]);
+}
+
+TEST_F(ReplacementsUtilsTest, UniteReplacementsKeepsUnboundColumns)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddr const & z = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 30; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  inference::Replacements first(ScAddrVector{x});
+  inference::Replacements second(ScAddrVector{y});
+  inference::Replacements third(ScAddrVector{x, z});
+  for (size_t i = 0; i < 10; ++i)
+  {
+    first.addRow({values[i]});
+    second.addRow({values[10 + i]});
+    third.addRow({values[i % 2 == 0 ? i : 20 + i], values[20 + i]});
+  }
+
+  inference::Replacements const & result = inference::ReplacementsUtils::uniteReplacements(
+      inference::ReplacementsUtils::uniteReplacements(first, second), third);
+  EXPECT_TRUE(result.hasUnboundColumns());
+  EXPECT_FALSE(result.empty());
+
+  inference::Replacements const & projection = result.project({x}).materialize();
+  EXPECT_TRUE(result.hasUnboundColumns());
+  EXPECT_EQ(projection.getRowsAmount(), 15u);
+
+  EXPECT_EQ(result.getVariables(), (ScAddrVector{x, y, z}));
+  EXPECT_EQ(result.getRowsAmount(), 10u * 10u * 10u + 5u * 10u);
+  EXPECT_TRUE(result.hasUnboundColumns());
+  EXPECT_TRUE(hasRow(result, {x, y, z}, {values[3], values[12], values[27]}));
+  EXPECT_TRUE(hasRow(result, {x, y, z}, {values[21], values[19], values[21]}));
+  EXPECT_FALSE(hasRow(result, {x, y, z}, {values[21], values[19], values[27]}));
+}
+
+TEST_F(ReplacementsUtilsTest, JoinReplacementsInParallel)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddr const & z = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 3000; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  // only the first 100 rows of the second have y equal to y of rows of the first
+  size_t const rowsAmount = inference::ReplacementsUtils::PARALLEL_MIN_ROWS_AMOUNT;
+  inference::Replacements first(ScAddrVector{x, y});
+  inference::Replacements second(ScAddrVector{y, z});
+  for (size_t i = 0; i < rowsAmount; ++i)
+  {
+    first.addRow({values[i % 2000], values[i % 1000]});
+    second.addRow({values[i < 100 ? i : 1000 + i % 2000], values[i % 3000]});
+  }
+
+  inference::Replacements const & serialResult =
+      inference::ReplacementsUtils::intersectReplacementsBySortMerge(first, second);
+  inference::Replacements const & parallelResult =
+      inference::ReplacementsUtils::intersectReplacementsInParallel(first, second);
+  EXPECT_EQ(parallelResult.getVariables(), serialResult.getVariables());
+  EXPECT_EQ(parallelResult.getRowsAmount(), 200u);
+  EXPECT_EQ(parallelResult.getRowsAmount(), serialResult.getRowsAmount());
+  for (inference::Replacements::Row const & row : serialResult)
+    EXPECT_TRUE(hasRow(parallelResult, serialResult.getVariables(), ScAddrVector(row.begin(), row.end())));
+
+  // rows of the first with y from the first 100 values are removed, duplicates of remaining rows too
+  inference::Replacements const & subtractionResult =
+      inference::ReplacementsUtils::subtractReplacementsInParallel(first, second);
+  EXPECT_EQ(subtractionResult.getRowsAmount(), 1800u);
+  size_t resultRow = 0;
+  for (size_t i = 0; i < 2000; ++i)
+  {
+    if (i % 1000 < 100)
+      continue;
+    EXPECT_EQ(subtractionResult.get(resultRow, 0), values[i]);
+    EXPECT_EQ(subtractionResult.get(resultRow, 1), values[i % 1000]);
+    ++resultRow;
+  }
+}
+
+TEST_F(ReplacementsUtilsTest, JoinReplacementsInParallelInMemoryBudget)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddr const & z = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 500; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  // replacements are created without arena, so only partitions and results of the join are in the budget
+  inference::Replacements first(ScAddrVector{x, y});
+  inference::Replacements second(ScAddrVector{y, z});
+  for (size_t i = 0; i < 200000; ++i)
+    first.addRow({values[i % 500], values[i / 500]});
+  for (size_t i = 0; i < 400; ++i)
+    second.addRow({values[i], values[499 - i]});
+
+  size_t const memoryBudget = 1 << 20;
+  inference::InferenceArena const arena(memoryBudget);
+  {
+    // hashes of partitions of the first take 1.6 MB and rows of the result take 4.8 MB
+    inference::Replacements const & intersection =
+        inference::ReplacementsUtils::intersectReplacementsInParallel(first, second);
+    EXPECT_GT(arena.getSpilledRowsBlocksAmount(), 0u);
+    EXPECT_GT(arena.getSpilledRowsMemorySize(), 0u);
+    EXPECT_LE(arena.getRowsMemorySize(), memoryBudget);
+    EXPECT_EQ(intersection.getRowsAmount(), 200000u);
+    EXPECT_TRUE(hasRow(intersection, {x, y, z}, {values[7], values[300], values[199]}));
+  }
+  EXPECT_EQ(arena.getSpilledRowsMemorySize(), 0u);
+  EXPECT_EQ(arena.getRowsMemorySize(), 0u);
+}
+
+TEST_F(ReplacementsUtilsTest, JoinCompressedReplacementsByCodes)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddr const & z = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 300; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  // y of the first takes 10 values and y of the second takes 20 values, only 10 of them are common
+  inference::Replacements first(ScAddrVector{x, y});
+  inference::Replacements second(ScAddrVector{y, z});
+  for (size_t i = 0; i < 4000; ++i)
+  {
+    first.addRow({values[i % 200], values[i % 10]});
+    second.addRow({values[5 + i % 20], values[i % 50]});
+  }
+  inference::Replacements const & intersectionResult =
+      inference::ReplacementsUtils::intersectReplacements(first, second);
+  inference::Replacements const & subtractionResult =
+      inference::ReplacementsUtils::subtractReplacements(first, second);
+
+  inference::Replacements compressedFirst = first;
+  inference::Replacements compressedSecond = second;
+  compressedFirst.compress();
+  compressedSecond.compress();
+  EXPECT_TRUE(compressedFirst.isCompressed());
+  EXPECT_FALSE(first.isCompressed());
+  // 1 byte for each value of a row instead of 4 bytes
+  EXPECT_LT(compressedFirst.getMemorySize() * 3, first.getMemorySize());
+  EXPECT_LT(compressedSecond.getMemorySize() * 3, second.getMemorySize());
+
+  inference::Replacements const & compressedIntersectionResult =
+      inference::ReplacementsUtils::intersectReplacementsByCodes(compressedFirst, compressedSecond);
+  EXPECT_TRUE(compressedIntersectionResult.isCompressed());
+  EXPECT_EQ(compressedIntersectionResult.getVariables(), intersectionResult.getVariables());
+  EXPECT_EQ(compressedIntersectionResult.getRowsAmount(), intersectionResult.getRowsAmount());
+  for (inference::Replacements::Row const & row : intersectionResult)
+    EXPECT_TRUE(
+        hasRow(compressedIntersectionResult, intersectionResult.getVariables(), ScAddrVector(row.begin(), row.end())));
+
+  inference::Replacements const & compressedSubtractionResult =
+      inference::ReplacementsUtils::subtractReplacementsByCodes(compressedFirst, compressedSecond);
+  EXPECT_EQ(compressedSubtractionResult.getRowsAmount(), subtractionResult.getRowsAmount());
+  for (size_t row = 0; row < subtractionResult.getRowsAmount(); ++row)
+  {
+    EXPECT_EQ(compressedSubtractionResult.get(row, 0), subtractionResult.get(row, 0));
+    EXPECT_EQ(compressedSubtractionResult.get(row, 1), subtractionResult.get(row, 1));
+  }
+  // access to rows decodes them to a copy, codes are kept
+  EXPECT_TRUE(compressedSubtractionResult.isCompressed());
+
+  // replacements joined by values with not compressed ones are decoded to temporary copies and keep their codes
+  inference::Replacements const & mixedIntersectionResult =
+      inference::ReplacementsUtils::intersectReplacementsByCodes(compressedFirst, second);
+  EXPECT_EQ(mixedIntersectionResult.getRowsAmount(), intersectionResult.getRowsAmount());
+  inference::Replacements const & mixedSubtractionResult =
+      inference::ReplacementsUtils::subtractReplacementsByCodes(compressedFirst, second);
+  EXPECT_EQ(mixedSubtractionResult.getRowsAmount(), subtractionResult.getRowsAmount());
+  EXPECT_TRUE(compressedFirst.isCompressed());
+  EXPECT_LT(compressedFirst.getMemorySize() * 3, first.getMemorySize());
+
+  // columns of distinct values take less memory without dictionaries
+  inference::Replacements distinctValues(ScAddrVector{x});
+  for (ScAddr const & value : values)
+    distinctValues.addRow({value});
+  distinctValues.compress();
+  EXPECT_FALSE(distinctValues.isCompressed());
+}
+
+TEST_F(ReplacementsUtilsTest, ThreadPoolRunsAllTasks)
+{
+  inference::ThreadPool pool(4);
+  std::vector<size_t> results(1000);
+  pool.run(results.size(), [&results, &pool](size_t task) {
+    std::vector<size_t> nestedResults(10);
+    pool.run(nestedResults.size(), [&nestedResults, task](size_t nestedTask) {
+      nestedResults[nestedTask] = task + nestedTask;
+    });
+    for (size_t const nestedResult : nestedResults)
+      results[task] += nestedResult;
+  });
+  for (size_t task = 0; task < results.size(); ++task)
+    EXPECT_EQ(results[task], task * 10 + 45);
+
+  EXPECT_THROW(
+      pool.run(
+          100,
+          [](size_t task) {
+            if (task == 50)
+              throw std::runtime_error("task is failed");
+          }),
+      std::runtime_error);
+}
+
+TEST_F(ReplacementsUtilsTest, ReplacementsKernels)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddrVector values;
+  for (size_t i = 0; i < 100; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+  SC_LOG_INFO("Replacements kernels use " << inference::ReplacementsKernels::getInstructionSet());
+
+  for (size_t keySize = 0; keySize < 10; ++keySize)
+  {
+    size_t const keysAmount = values.size() / std::max<size_t>(keySize, 1);
+    std::vector<uint64_t> hashes(keysAmount);
+    inference::ReplacementsKernels::hashKeys(values.data(), keySize, keysAmount, hashes.data());
+    for (size_t key = 0; key < keysAmount; ++key)
+      EXPECT_EQ(hashes[key], inference::ReplacementsHashIndex::hashKey(values.data() + key * keySize, keySize));
+  }
+
+  for (size_t keySize = 0; keySize < 20; ++keySize)
+  {
+    ScAddrVector key(values.cbegin(), values.cbegin() + keySize);
+    EXPECT_TRUE(inference::ReplacementsKernels::areKeysEqual(key.data(), values.data(), keySize));
+    for (size_t index = 0; index < keySize; ++index)
+    {
+      key[index] = values[keySize];
+      EXPECT_FALSE(inference::ReplacementsKernels::areKeysEqual(key.data(), values.data(), keySize));
+      key[index] = values[index];
+    }
+  }
+}
+
+TEST_F(ReplacementsUtilsTest, ReplacementsToScTemplateParams)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & a = context.CreateNode(ScType::NodeConst);
+  ScAddr const & b = context.CreateNode(ScType::NodeConst);
+
+  inference::Replacements replacements(ScAddrVector{x});
+  replacements.addRow({a});
+  replacements.addRow({b});
+
+  std::vector<ScTemplateParams> const & paramsVector =
+      inference::ReplacementsUtils::getReplacementsToScTemplateParams(replacements);
+  EXPECT_EQ(paramsVector.size(), 2u);
+  ScAddr value;
+  EXPECT_TRUE(paramsVector[1].Get(x, value));
+  EXPECT_EQ(value, b);
+}
+
+TEST_F(ReplacementsUtilsTest, ProjectionToScTemplateParams)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddr const & a = context.CreateNode(ScType::NodeConst);
+  ScAddr const & b = context.CreateNode(ScType::NodeConst);
+  ScAddr const & c = context.CreateNode(ScType::NodeConst);
+
+  inference::Replacements replacements(ScAddrVector{x, y});
+  replacements.addRow({a, c});
+  replacements.addRow({b, c});
+  std::vector<ScTemplateParams> const & paramsVector =
+      inference::ReplacementsUtils::getReplacementsToScTemplateParams(replacements.projectWithout({x}));
+  EXPECT_EQ(paramsVector.size(), 2u);
+  ScAddr value;
+  EXPECT_FALSE(paramsVector[0].Get(x, value));
+  EXPECT_TRUE(paramsVector[0].Get(y, value));
+  EXPECT_EQ(value, c);
+
+  // rows with unbound columns are expanded only by projected columns, so y values are not repeated for each x value
+  inference::Replacements yValues(ScAddrVector{y});
+  yValues.addRow({a});
+  yValues.addRow({b});
+  inference::Replacements xValues(ScAddrVector{x});
+  xValues.addRow({a});
+  xValues.addRow({c});
+  inference::Replacements const & united = inference::ReplacementsUtils::uniteReplacements(yValues, xValues);
+  ASSERT_TRUE(united.hasUnboundColumns());
+  EXPECT_EQ(inference::ReplacementsUtils::getReplacementsToScTemplateParams(united.projectWithout({x})).size(), 2u);
+}
+
+TEST_F(ReplacementsUtilsTest, TemplateParamsCursor)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddrVector values;
+  for (size_t i = 0; i < 3; ++i)
+    values.push_back(context.CreateNode(ScType::NodeConst));
+
+  inference::Replacements replacements(ScAddrVector{x, y});
+  for (size_t i = 0; i < values.size(); ++i)
+    replacements.addRow({values[i], values[values.size() - 1 - i]});
+
+  inference::TemplateParamsCursor cursor(replacements.projectWithout({y}));
+  EXPECT_EQ(cursor.getRowsAmount(), values.size());
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    for (ScAddr const & expectedValue : values)
+    {
+      ASSERT_TRUE(cursor.next());
+      ScAddr value;
+      EXPECT_TRUE(cursor.getParams().Get(x, value));
+      EXPECT_EQ(value, expectedValue);
+      EXPECT_FALSE(cursor.getParams().Get(y, value));
+    }
+    EXPECT_FALSE(cursor.next());
+    cursor.reset();
+  }
+
+  inference::TemplateParamsCursor emptyCursor(replacements.projectWithout({x, y}));
+  EXPECT_FALSE(emptyCursor.next());
+}
+TEST_F(ReplacementsUtilsTest, BuilderRejectsDuplicateRows)
+{
+  ScMemoryContext & context = *m_ctx;
+  ScAddr const & x = context.CreateNode(ScType::NodeVar);
+  ScAddr const & y = context.CreateNode(ScType::NodeVar);
+  ScAddr const & a = context.CreateNode(ScType::NodeConst);
+  ScAddr const & b = context.CreateNode(ScType::NodeConst);
+
+  inference::Replacements replacements(ScAddrVector{x, y});
+  inference::ReplacementsBuilder builder(replacements);
+  auto const & addRow = [&builder](ScAddr const & xValue, ScAddr const & yValue) {
+    ScAddr * row = builder.addRow();
+    row[0] = xValue;
+    row[1] = yValue;
+    return builder.commitRow();
+  };
+  EXPECT_TRUE(addRow(a, b));
+  EXPECT_TRUE(addRow(b, a));
+  EXPECT_FALSE(addRow(a, b));
+  EXPECT_FALSE(addRow(b, a));
+  EXPECT_EQ(replacements.getRowsAmount(), 2u);
+  EXPECT_TRUE(hasRow(replacements, {x, y}, {a, b}));
+  EXPECT_TRUE(hasRow(replacements, {x, y}, {b, a}));
+
+  // rows taken by the consumer are forgotten, so they may be added again
+  replacements.truncate(0);
+  EXPECT_TRUE(addRow(a, b));
+  EXPECT_FALSE(addRow(a, b));
+  EXPECT_EQ(replacements.getRowsAmount(), 1u);
+}
+}  // namespace inferenceTest
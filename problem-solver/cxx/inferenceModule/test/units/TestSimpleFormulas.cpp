@@ -126,6 +126,37 @@ TEST_F(InferenceSimpleFormulasTest, TrueSimpleLogicRuleThreeArguments)
   context.Destroy();
 }
 
+// a -> b; Simple test with only one implication and memory budget of inference given by the action
+TEST_F(InferenceSimpleFormulasTest, TrueSimpleLogicRuleWithMemoryBudget)
+{
+  ScMemoryContext context(sc_access_lvl_make_min, "successful_inference");
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "trueSimpleRuleTest.scs");
+  initialize();
+
+  ScAddr action = context.HelperResolveSystemIdtf("memory_budget_action");
+  EXPECT_TRUE(action.IsValid());
+  EXPECT_EQ(inference::DirectInferenceAgent::getMemoryBudget(&context, action), 1048576u);
+  EXPECT_EQ(
+      inference::DirectInferenceAgent::getMemoryBudget(
+          &context, context.HelperResolveSystemIdtf("four_arguments_action")),
+      0u);
+
+  ScAddr argument = context.HelperFindBySystemIdtf("argument");
+  EXPECT_TRUE(argument.IsValid());
+
+  EXPECT_TRUE(utils::AgentUtils::applyAction(&context, action, WAIT_TIME, InferenceKeynodes::action_direct_inference));
+  EXPECT_TRUE(context.HelperCheckEdge(
+      scAgentsCommon::CoreKeynodes::question_finished_successfully, action, ScType::EdgeAccessConstPosPerm));
+
+  // The class is generated with the memory budget as without it
+  EXPECT_TRUE(context.HelperCheckEdge(
+      context.HelperFindBySystemIdtf("target_node_class"), argument, ScType::EdgeAccessConstPosPerm));
+
+  shutdown();
+  context.Destroy();
+}
+
 // a -> b; b -> c. Should apply both of them to achieve the target
 TEST_F(InferenceSimpleFormulasTest, TrueDoubleApplyLogicRule)
 {
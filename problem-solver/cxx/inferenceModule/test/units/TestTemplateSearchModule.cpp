@@ -12,9 +12,14 @@
 #include "searcher/templateSearcher/TemplateSearcherGeneral.hpp"
 #include "searcher/templateSearcher/TemplateSearcherOnlyAccessEdgesInStructures.hpp"
 #include "keynodes/InferenceKeynodes.hpp"
+#include "utils/InferenceArena.hpp"
 #include "utils/ReplacementsUtils.hpp"
+#include "utils/TemplateCache.hpp"
+#include "utils/ThreadPool.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <thread>
 
 namespace inferenceTest
 {
@@ -90,7 +95,7 @@ TEST_F(TemplateSearchManagerTest, SearchWithContent_SingleResultTestCase)
 
   ScAddrVector const & vars = utils::IteratorUtils::getAllWithType(&context, searchTemplateAddr, ScType::Var);
   inference::ScAddrHashSet templateVars = {vars.cbegin(), vars.cend()};
-  EXPECT_EQ(searchResults.size(), templateVars.size());
+  EXPECT_EQ(searchResults.getColumnsAmount(), templateVars.size());
   EXPECT_EQ(
       searchResults.at(context.HelperFindBySystemIdtf(searchLinkIdentifier))[0],
       context.HelperFindBySystemIdtf(correctResultLinkIdentifier));
@@ -124,7 +129,7 @@ TEST_F(TemplateSearchManagerTest, SearchInMultipleStructuresWithContent_SingleRe
 
   ScAddrVector const & vars = utils::IteratorUtils::getAllWithType(&context, searchTemplateAddr, ScType::Var);
   inference::ScAddrHashSet templateVars = {vars.cbegin(), vars.cend()};
-  EXPECT_EQ(searchResults.size(), templateVars.size());
+  EXPECT_EQ(searchResults.getColumnsAmount(), templateVars.size());
   EXPECT_EQ(
       searchResults.at(context.HelperFindBySystemIdtf(searchLinkIdentifier))[0],
       context.HelperFindBySystemIdtf(correctResultLinkIdentifier));
@@ -174,7 +179,7 @@ TEST_F(TemplateSearchManagerTest, SearchWithoutContent_SingleResultTestCase)
 
   ScAddrVector const & vars = utils::IteratorUtils::getAllWithType(&context, searchTemplateAddr, ScType::Var);
   inference::ScAddrHashSet templateVars = {vars.cbegin(), vars.cend()};
-  EXPECT_EQ(searchResults.size(), templateVars.size());
+  EXPECT_EQ(searchResults.getColumnsAmount(), templateVars.size());
 
   EXPECT_EQ(
       searchResults.at(context.HelperFindBySystemIdtf(searchLinkIdentifier))[0],
@@ -204,7 +209,7 @@ TEST_F(TemplateSearchManagerTest, SearchWithoutContent_EmptyLinkTestCase)
 
   ScAddrVector const & vars = utils::IteratorUtils::getAllWithType(&context, searchTemplateAddr, ScType::Var);
   inference::ScAddrHashSet templateVars = {vars.cbegin(), vars.cend()};
-  EXPECT_EQ(searchResults.size(), templateVars.size());
+  EXPECT_EQ(searchResults.getColumnsAmount(), templateVars.size());
   EXPECT_EQ(
       searchResults.at(context.HelperFindBySystemIdtf(searchLinkIdentifier))[0],
       context.HelperFindBySystemIdtf(correctResultLinkIdentifier));
@@ -230,7 +235,7 @@ TEST_F(TemplateSearchManagerTest, SearchWithContent_EmptyLinkTestCase)
 
   ScAddrVector const & vars = utils::IteratorUtils::getAllWithType(&context, searchTemplateAddr, ScType::Var);
   inference::ScAddrHashSet templateVars = {vars.cbegin(), vars.cend()};
-  EXPECT_EQ(searchResults.size(), templateVars.size());
+  EXPECT_EQ(searchResults.getColumnsAmount(), templateVars.size());
   EXPECT_EQ(
       searchResults.at(context.HelperFindBySystemIdtf(searchLinkIdentifier))[0],
       context.HelperFindBySystemIdtf(correctResultLinkIdentifier));
@@ -265,8 +270,8 @@ TEST_F(TemplateSearchManagerTest, SearchWithExistedConstructionsTest)
       {templateVars.cbegin(), templateVars.cend()},
       searchResults);
 
-  EXPECT_EQ(searchResults.size(), templateVars.size());
-  EXPECT_EQ(inference::ReplacementsUtils::getColumnsAmount(searchResults), 1u);
+  EXPECT_EQ(searchResults.getColumnsAmount(), templateVars.size());
+  EXPECT_EQ(searchResults.getRowsAmount(), 1u);
 }
 
 TEST_F(TemplateSearchManagerTest, SearchWithoutAccessEdgesTest)
@@ -293,7 +298,357 @@ TEST_F(TemplateSearchManagerTest, SearchWithoutAccessEdgesTest)
       {templateVars.cbegin(), templateVars.cend()},
       searchResults);
 
-  EXPECT_EQ(searchResults.size(), templateVars.size());
-  EXPECT_EQ(inference::ReplacementsUtils::getColumnsAmount(searchResults), 1u);
+  EXPECT_EQ(searchResults.getColumnsAmount(), templateVars.size());
+  EXPECT_EQ(searchResults.getRowsAmount(), 1u);
+}
+
+TEST_F(TemplateSearchManagerTest, SearchWithCachedTemplateTest)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithoutContentSingleResultTestStucture.scs");
+  initialize();
+
+  ScAddr searchTemplateAddr = context.HelperFindBySystemIdtf(TEST_SEARCH_TEMPLATE_ID);
+  ScAddr const & nodeVariable = context.HelperFindBySystemIdtf("_node");
+  ScAddr const & firstConstantNode = context.HelperFindBySystemIdtf("first_constant_node");
+  inference::TemplateSearcherGeneral templateSearcher(&context);
+  inference::ScAddrHashSet variables;
+  templateSearcher.getVariables(searchTemplateAddr, variables);
+
+  // the template is built from the formula read once and then from cached triples with other params
+  inference::Replacements searchResults;
+  templateSearcher.searchTemplate(searchTemplateAddr, ScTemplateParams(), variables, searchResults);
+  EXPECT_EQ(searchResults.getRowsAmount(), 1u);
+  EXPECT_EQ(templateSearcher.getTemplateCache().getFormulasAmount(), 1u);
+  EXPECT_EQ(templateSearcher.getTemplateCache().getReadsAmount(), 1u);
+
+  ScTemplateParams boundParams;
+  boundParams.Add(nodeVariable, firstConstantNode);
+  inference::Replacements boundSearchResults;
+  templateSearcher.searchTemplate(searchTemplateAddr, boundParams, variables, boundSearchResults);
+  EXPECT_EQ(boundSearchResults.getRowsAmount(), 1u);
+  EXPECT_EQ(boundSearchResults.at(nodeVariable)[0], firstConstantNode);
+
+  ScTemplateParams otherParams;
+  otherParams.Add(nodeVariable, context.HelperFindBySystemIdtf("correct_result_link"));
+  inference::Replacements otherSearchResults;
+  templateSearcher.searchTemplate(searchTemplateAddr, otherParams, variables, otherSearchResults);
+  EXPECT_TRUE(otherSearchResults.empty());
+  EXPECT_EQ(templateSearcher.getTemplateCache().getFormulasAmount(), 1u);
+  EXPECT_EQ(templateSearcher.getTemplateCache().getReadsAmount(), 1u);
+}
+
+TEST_F(TemplateSearchManagerTest, SearchWithChangedCachedTemplateTest)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithoutContentSingleResultTestStucture.scs");
+  initialize();
+
+  ScAddr searchTemplateAddr = context.HelperFindBySystemIdtf(TEST_SEARCH_TEMPLATE_ID);
+  ScAddr const & nodeVariable = context.HelperFindBySystemIdtf("_node");
+  ScAddr const & testClass = context.HelperFindBySystemIdtf("test_class");
+  // the node without link is not found while the formula has the triple of the link
+  ScAddr const & nodeWithoutLink = context.CreateNode(ScType::NodeConst);
+  context.CreateEdge(ScType::EdgeAccessConstPosPerm, testClass, nodeWithoutLink);
+  inference::TemplateSearcherGeneral templateSearcher(&context);
+  inference::ScAddrHashSet const variables = {nodeVariable};
+
+  inference::Replacements searchResults;
+  templateSearcher.searchTemplate(searchTemplateAddr, ScTemplateParams(), variables, searchResults);
+  EXPECT_EQ(searchResults.getRowsAmount(), 1u);
+  EXPECT_EQ(templateSearcher.getTemplateCache().getReadsAmount(), 1u);
+
+  // the triple of the link is removed from the formula, so cached triples are read again
+  ScIterator3Ptr const & linkEdgeIterator =
+      context.Iterator3(nodeVariable, ScType::EdgeAccessVarPosPerm, ScType::Unknown);
+  ASSERT_TRUE(linkEdgeIterator->Next());
+  ScIterator3Ptr const & membershipIterator =
+      context.Iterator3(searchTemplateAddr, ScType::EdgeAccessConstPosPerm, linkEdgeIterator->Get(1));
+  ASSERT_TRUE(membershipIterator->Next());
+  context.EraseElement(membershipIterator->Get(1));
+
+  // events of the formula are processed asynchronously, so the search is repeated until they come
+  inference::Replacements changedSearchResults;
+  for (size_t attempt = 0; attempt < 500 && templateSearcher.getTemplateCache().getReadsAmount() < 2; ++attempt)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    changedSearchResults = inference::Replacements();
+    templateSearcher.searchTemplate(searchTemplateAddr, ScTemplateParams(), variables, changedSearchResults);
+  }
+  EXPECT_EQ(templateSearcher.getTemplateCache().getReadsAmount(), 2u);
+  inference::Replacements::Column const & foundNodes = changedSearchResults.at(nodeVariable);
+  ASSERT_EQ(foundNodes.getSize(), 2u);
+  EXPECT_TRUE(foundNodes[0] == nodeWithoutLink || foundNodes[1] == nodeWithoutLink);
+}
+
+TEST_F(TemplateSearchManagerTest, SearchWithParamsGroupsTest)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithoutContentSingleResultTestStucture.scs");
+  initialize();
+
+  ScAddr searchTemplateAddr = context.HelperFindBySystemIdtf(TEST_SEARCH_TEMPLATE_ID);
+  ScAddr const & nodeVariable = context.HelperFindBySystemIdtf("_node");
+  ScAddr const & firstConstantNode = context.HelperFindBySystemIdtf("first_constant_node");
+  inference::TemplateSearcherGeneral templateSearcher(&context);
+  inference::ScAddrHashSet variables;
+  templateSearcher.getVariables(searchTemplateAddr, variables);
+
+  // params binding the same values are searched once, so the found row is not repeated
+  std::vector<ScTemplateParams> paramsVector(3);
+  paramsVector[0].Add(nodeVariable, firstConstantNode);
+  paramsVector[1].Add(nodeVariable, firstConstantNode);
+  paramsVector[2].Add(nodeVariable, context.HelperFindBySystemIdtf("correct_result_link"));
+  inference::Replacements searchResults;
+  templateSearcher.searchTemplate(searchTemplateAddr, paramsVector, variables, searchResults);
+  EXPECT_EQ(searchResults.getRowsAmount(), 1u);
+  EXPECT_EQ(searchResults.at(nodeVariable)[0], firstConstantNode);
+}
+
+TEST_F(TemplateSearchManagerTest, SearchWithManyParamsTest)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithoutContentSingleResultTestStucture.scs");
+  initialize();
+
+  ScAddr searchTemplateAddr = context.HelperFindBySystemIdtf(TEST_SEARCH_TEMPLATE_ID);
+  ScAddr const & nodeVariable = context.HelperFindBySystemIdtf("_node");
+  ScAddr const & testClass = context.HelperFindBySystemIdtf("test_class");
+  // own thread pool makes the search parallel even if the shared one has a single thread
+  inference::ThreadPool threadPool(4);
+  inference::TemplateSearcherGeneral templateSearcher(&context);
+  templateSearcher.setThreadPool(threadPool);
+  inference::ScAddrHashSet variables;
+  templateSearcher.getVariables(searchTemplateAddr, variables);
+
+  // enough params to split them between threads, rows found by each thread are added in order of params
+  size_t const paramsAmount = inference::TemplateSearcherAbstract::PARALLEL_SEARCH_MIN_PARAMS_AMOUNT * 2;
+  std::vector<ScTemplateParams> paramsVector(paramsAmount);
+  ScAddrVector nodes;
+  for (ScTemplateParams & params : paramsVector)
+  {
+    ScAddr const & node = context.CreateNode(ScType::NodeConst);
+    context.CreateEdge(ScType::EdgeAccessConstPosPerm, testClass, node);
+    context.CreateEdge(ScType::EdgeAccessConstPosPerm, node, context.CreateLink());
+    params.Add(nodeVariable, node);
+    nodes.push_back(node);
+  }
+  // rows found by tasks in threads of the pool are allocated from the arena of this thread
+  inference::InferenceArena const arena;
+  {
+    inference::Replacements searchResults;
+    templateSearcher.searchTemplate(searchTemplateAddr, paramsVector, variables, searchResults);
+    EXPECT_EQ(templateSearcher.getTaskSearchersAmount(), threadPool.getThreadsAmount());
+    inference::Replacements::Column const & foundNodes = searchResults.at(nodeVariable);
+    ASSERT_EQ(foundNodes.getSize(), paramsAmount);
+    for (size_t row = 0; row < paramsAmount; ++row)
+      EXPECT_EQ(foundNodes[row], nodes[row]);
+    EXPECT_GT(arena.getRowsMemorySize(), 0u);
+
+    // clones of the searcher are kept for the next parallel search
+    inference::Replacements nextSearchResults;
+    templateSearcher.searchTemplate(searchTemplateAddr, paramsVector, variables, nextSearchResults);
+    EXPECT_EQ(templateSearcher.getTaskSearchersAmount(), threadPool.getThreadsAmount());
+    EXPECT_EQ(nextSearchResults.getRowsAmount(), paramsAmount);
+  }
+  EXPECT_EQ(arena.getRowsMemorySize(), 0u);
+}
+
+TEST_F(TemplateSearchManagerTest, SearchInStructuresWithSameIndexTest)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithContentSingleResultTestStructure.scs");
+  initialize();
+
+  ScAddr searchTemplateAddr = context.HelperFindBySystemIdtf(TEST_SEARCH_TEMPLATE_ID);
+  ScAddr const & nodeVariable = context.HelperFindBySystemIdtf("_node");
+  ScAddr const & firstConstantNode = context.HelperFindBySystemIdtf("first_constant_node");
+  inference::TemplateSearcherInStructures templateSearcher(&context);
+  templateSearcher.setInputStructures(
+      {context.HelperFindBySystemIdtf("input_structure_1"), context.HelperFindBySystemIdtf("input_structure_2")});
+  inference::ScAddrHashSet variables;
+  templateSearcher.getVariables(searchTemplateAddr, variables);
+
+  // elements of input structures are read for the first search and checked by both replacements using types
+  for (ReplacementsUsingType const replacementsUsingType : {REPLACEMENTS_ALL, REPLACEMENTS_FIRST, REPLACEMENTS_ALL})
+  {
+    templateSearcher.setReplacementsUsingType(replacementsUsingType);
+    inference::Replacements searchResults;
+    templateSearcher.searchTemplate(searchTemplateAddr, ScTemplateParams(), variables, searchResults);
+    ASSERT_EQ(searchResults.getRowsAmount(), 1u);
+    EXPECT_EQ(searchResults.at(nodeVariable)[0], firstConstantNode);
+  }
+}
+
+TEST_F(TemplateSearchManagerTest, SearchInStructuresWithAddedElementsTest)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithContentSingleResultTestStructure.scs");
+  initialize();
+
+  ScAddr searchTemplateAddr = context.HelperFindBySystemIdtf(TEST_SEARCH_TEMPLATE_ID);
+  ScAddr const & nodeVariable = context.HelperFindBySystemIdtf("_node");
+  ScAddr const & inputStructure = context.HelperFindBySystemIdtf("input_structure_1");
+  inference::TemplateSearcherInStructures templateSearcher(&context);
+  templateSearcher.setInputStructures({inputStructure, context.HelperFindBySystemIdtf("input_structure_2")});
+  templateSearcher.setReplacementsUsingType(REPLACEMENTS_ALL);
+  inference::ScAddrHashSet variables;
+  templateSearcher.getVariables(searchTemplateAddr, variables);
+  inference::Replacements searchResults;
+  templateSearcher.searchTemplate(searchTemplateAddr, ScTemplateParams(), variables, searchResults);
+  EXPECT_EQ(searchResults.getRowsAmount(), 1u);
+
+  // elements added by inference are found by the next search without reading input structures again
+  ScAddr const & node = context.CreateNode(ScType::NodeConst);
+  ScAddr const & link = context.CreateLink();
+  context.SetLinkContent(link, "text");
+  ScAddrVector const & addedElements = {
+      node,
+      link,
+      context.CreateEdge(ScType::EdgeAccessConstPosPerm, context.HelperFindBySystemIdtf("test_class"), node),
+      context.CreateEdge(ScType::EdgeAccessConstPosPerm, node, link)};
+  for (ScAddr const & element : addedElements)
+  {
+    context.CreateEdge(ScType::EdgeAccessConstPosPerm, inputStructure, element);
+    templateSearcher.onStructureElementAdded(inputStructure, element);
+  }
+  inference::Replacements nextSearchResults;
+  templateSearcher.searchTemplate(searchTemplateAddr, ScTemplateParams(), variables, nextSearchResults);
+  ASSERT_EQ(nextSearchResults.getRowsAmount(), 2u);
+  EXPECT_TRUE(nextSearchResults.at(nodeVariable)[0] == node || nextSearchResults.at(nodeVariable)[1] == node);
+}
+
+TEST_F(TemplateSearchManagerTest, SearchWithContentFromLinksFoundByContentTest)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithContentSingleResultTestStructure.scs");
+  initialize();
+
+  ScAddr searchTemplateAddr = context.HelperFindBySystemIdtf(TEST_SEARCH_TEMPLATE_ID);
+  ScAddr const & searchLink = context.HelperFindBySystemIdtf("search_link");
+  ScAddr const & nodeVariable = context.HelperFindBySystemIdtf("_node");
+  inference::TemplateSearcherGeneral templateSearcher(&context);
+  inference::ScAddrHashSet variables;
+  templateSearcher.getVariables(searchTemplateAddr, variables);
+  inference::Replacements searchResults;
+  templateSearcher.searchTemplate(searchTemplateAddr, ScTemplateParams(), variables, searchResults);
+  ASSERT_EQ(searchResults.getRowsAmount(), 1u);
+  EXPECT_EQ(searchResults.at(searchLink)[0], context.HelperFindBySystemIdtf("correct_result_link"));
+
+  // links created after the previous search are found by content in the next search
+  ScAddr const & node = context.CreateNode(ScType::NodeConst);
+  ScAddr const & link = context.CreateLink();
+  context.SetLinkContent(link, "text");
+  context.CreateEdge(ScType::EdgeAccessConstPosPerm, context.HelperFindBySystemIdtf("test_class"), node);
+  context.CreateEdge(ScType::EdgeAccessConstPosPerm, node, link);
+  ScTemplateParams templateParams;
+  templateParams.Add(nodeVariable, node);
+  inference::Replacements nextSearchResults;
+  templateSearcher.searchTemplate(searchTemplateAddr, templateParams, variables, nextSearchResults);
+  ASSERT_EQ(nextSearchResults.getRowsAmount(), 1u);
+  EXPECT_EQ(nextSearchResults.at(searchLink)[0], link);
+  EXPECT_EQ(nextSearchResults.at(nodeVariable)[0], node);
+}
+
+TEST_F(TemplateSearchManagerTest, SearchFromSelectiveConstantTest)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  initialize();
+
+  // the formula triple with the huge class is written first, the search starts from the selective node instead
+  ScAddr const & hugeClass = context.CreateNode(ScType::NodeConstClass);
+  ScAddr const & selectiveNode = context.CreateNode(ScType::NodeConst);
+  ScAddr selectedNode;
+  for (size_t index = 0; index < 2000; ++index)
+  {
+    ScAddr const & node = context.CreateNode(ScType::NodeConst);
+    context.CreateEdge(ScType::EdgeAccessConstPosPerm, hugeClass, node);
+    if (index == 1000)
+    {
+      context.CreateEdge(ScType::EdgeAccessConstPosPerm, selectiveNode, node);
+      selectedNode = node;
+    }
+  }
+
+  ScAddr const & formula = context.CreateNode(ScType::NodeConstStruct);
+  ScAddr const & nodeVariable = context.CreateNode(ScType::NodeVar);
+  ScAddr const & selectiveEdge = context.CreateEdge(ScType::EdgeAccessVarPosPerm, selectiveNode, nodeVariable);
+  for (ScAddr const & element :
+       {hugeClass,
+        nodeVariable,
+        context.CreateEdge(ScType::EdgeAccessVarPosPerm, hugeClass, nodeVariable),
+        selectiveNode,
+        selectiveEdge})
+    context.CreateEdge(ScType::EdgeAccessConstPosPerm, formula, element);
+
+  inference::TemplateCache templateCache(&context);
+  std::vector<std::array<ScAddr, 3>> const & triples = templateCache.getTriples(formula);
+  ASSERT_EQ(triples.size(), 2u);
+  EXPECT_EQ(triples[0][0], selectiveNode);
+  EXPECT_EQ(triples[0][1], selectiveEdge);
+  EXPECT_EQ(triples[1][0], hugeClass);
+
+  inference::TemplateSearcherGeneral templateSearcher(&context);
+  templateSearcher.setReplacementsUsingType(REPLACEMENTS_ALL);
+  inference::ScAddrHashSet variables;
+  templateSearcher.getVariables(formula, variables);
+  inference::Replacements searchResults;
+  templateSearcher.searchTemplate(formula, ScTemplateParams(), variables, searchResults);
+  ASSERT_EQ(searchResults.getRowsAmount(), 1u);
+  EXPECT_EQ(searchResults.at(nodeVariable)[0], selectedNode);
+}
+
+TEST_F(TemplateSearchManagerTest, SearchWithTripleOfFormulaEdgeTest)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  initialize();
+
+  // the relation has less edges than the huge class, but its triple refers to the edge of the class triple
+  ScAddr const & hugeClass = context.CreateNode(ScType::NodeConstClass);
+  ScAddr const & relation = context.CreateNode(ScType::NodeConstRole);
+  ScAddr selectedNode;
+  for (size_t index = 0; index < 2000; ++index)
+  {
+    ScAddr const & node = context.CreateNode(ScType::NodeConst);
+    ScAddr const & edge = context.CreateEdge(ScType::EdgeAccessConstPosPerm, hugeClass, node);
+    if (index == 1000)
+    {
+      context.CreateEdge(ScType::EdgeAccessConstPosPerm, relation, edge);
+      selectedNode = node;
+    }
+  }
+
+  ScAddr const & formula = context.CreateNode(ScType::NodeConstStruct);
+  ScAddr const & nodeVariable = context.CreateNode(ScType::NodeVar);
+  ScAddr const & classEdge = context.CreateEdge(ScType::EdgeAccessVarPosPerm, hugeClass, nodeVariable);
+  ScAddr const & relationEdge = context.CreateEdge(ScType::EdgeAccessVarPosPerm, relation, classEdge);
+  for (ScAddr const & element : {relation, relationEdge, hugeClass, nodeVariable, classEdge})
+    context.CreateEdge(ScType::EdgeAccessConstPosPerm, formula, element);
+
+  // the edge alias is declared by the triple of the edge before the triple referring to it
+  inference::TemplateCache templateCache(&context);
+  std::vector<std::array<ScAddr, 3>> const & triples = templateCache.getTriples(formula);
+  ASSERT_EQ(triples.size(), 2u);
+  EXPECT_EQ(triples[0][1], classEdge);
+  EXPECT_EQ(triples[1][1], relationEdge);
+  EXPECT_EQ(triples[1][2], classEdge);
+
+  inference::TemplateSearcherGeneral templateSearcher(&context);
+  templateSearcher.setReplacementsUsingType(REPLACEMENTS_ALL);
+  inference::ScAddrHashSet variables;
+  templateSearcher.getVariables(formula, variables);
+  inference::Replacements searchResults;
+  templateSearcher.searchTemplate(formula, ScTemplateParams(), variables, searchResults);
+  ASSERT_EQ(searchResults.getRowsAmount(), 1u);
+  EXPECT_EQ(searchResults.at(nodeVariable)[0], selectedNode);
 }
 }  // namespace inferenceTest
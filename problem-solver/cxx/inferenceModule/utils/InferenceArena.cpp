@@ -0,0 +1,88 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "InferenceArena.hpp"
+
+namespace inference
+{
+thread_local InferenceArena * InferenceArena::currentArena = nullptr;
+thread_local std::pmr::memory_resource * InferenceArena::currentMemoryResource = nullptr;
+thread_local std::pmr::memory_resource * InferenceArena::currentRowsMemoryResource = nullptr;
+
+InferenceArena::InferenceArena(size_t memoryBudget)
+  : pool(std::pmr::new_delete_resource())
+  , rows(memoryBudget, &pool)
+  , synchronizedPool(&pool, mutex)
+  , synchronizedRows(&rows, mutex)
+  , previousArena(currentArena)
+  , previousMemoryResource(currentMemoryResource)
+  , previousRowsMemoryResource(currentRowsMemoryResource)
+{
+  currentArena = this;
+  currentMemoryResource = &pool;
+  currentRowsMemoryResource = &rows;
+}
+
+InferenceArena::~InferenceArena()
+{
+  currentArena = previousArena;
+  currentMemoryResource = previousMemoryResource;
+  currentRowsMemoryResource = previousRowsMemoryResource;
+}
+
+std::pmr::memory_resource * InferenceArena::getMemoryResource()
+{
+  return currentMemoryResource ? currentMemoryResource : std::pmr::get_default_resource();
+}
+
+std::pmr::memory_resource * InferenceArena::getRowsMemoryResource()
+{
+  if (currentRowsMemoryResource)
+    return currentRowsMemoryResource;
+  return std::pmr::get_default_resource();
+}
+
+bool InferenceArena::isSpilling()
+{
+  return currentArena && currentArena->rows.getSpilledMemorySize() > 0;
+}
+
+SharedInferenceArena::SharedInferenceArena()
+  : arena(InferenceArena::currentArena)
+  , previousMemoryResource(InferenceArena::currentMemoryResource)
+  , previousRowsMemoryResource(InferenceArena::currentRowsMemoryResource)
+{
+  // the thread runs tasks of loops too, so it takes blocks under the same mutex as tasks in other threads
+  if (arena)
+  {
+    InferenceArena::currentMemoryResource = &arena->synchronizedPool;
+    InferenceArena::currentRowsMemoryResource = &arena->synchronizedRows;
+  }
+}
+
+SharedInferenceArena::~SharedInferenceArena()
+{
+  InferenceArena::currentMemoryResource = previousMemoryResource;
+  InferenceArena::currentRowsMemoryResource = previousRowsMemoryResource;
+}
+
+SharedInferenceArena::TaskScope::TaskScope(SharedInferenceArena const & sharedArena)
+  : previousArena(InferenceArena::currentArena)
+  , previousMemoryResource(InferenceArena::currentMemoryResource)
+  , previousRowsMemoryResource(InferenceArena::currentRowsMemoryResource)
+{
+  InferenceArena::currentArena = sharedArena.arena;
+  InferenceArena::currentMemoryResource = sharedArena.arena ? &sharedArena.arena->synchronizedPool : nullptr;
+  InferenceArena::currentRowsMemoryResource = sharedArena.arena ? &sharedArena.arena->synchronizedRows : nullptr;
+}
+
+SharedInferenceArena::TaskScope::~TaskScope()
+{
+  InferenceArena::currentArena = previousArena;
+  InferenceArena::currentMemoryResource = previousMemoryResource;
+  InferenceArena::currentRowsMemoryResource = previousRowsMemoryResource;
+}
+}  // namespace inference
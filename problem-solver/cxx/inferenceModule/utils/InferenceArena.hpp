@@ -0,0 +1,126 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <memory_resource>
+#include <mutex>
+
+#include "SpillingMemoryResource.hpp"
+#include "SynchronizedMemoryResource.hpp"
+
+namespace inference
+{
+/**
+ * @brief Memory arena of one inference run. While the arena is alive, replacements and join helpers created in its
+ * thread allocate memory from it: freed blocks are reused by a pool, blocks bigger than pooled ones are returned to
+ * the heap as soon as they are freed and memory of the pool is released at once with the arena. Each thread has
+ * its own arena, so concurrent agents do not contend in malloc. Replacements allocated from the arena should not
+ * outlive it.
+ *
+ * Rows of replacements and arrays sized by rows of join helpers are accounted in the memory budget of the arena: big
+ * blocks of them beyond the budget are spilled to temporary files mapped to memory.
+ *
+ * Tasks of parallel loops allocate from the arena of the thread that runs the loop through SharedInferenceArena
+ */
+class InferenceArena
+{
+public:
+  /// @param memoryBudget greatest amount of bytes of rows of replacements kept in memory, 0 for no limit
+  explicit InferenceArena(size_t memoryBudget = 0);
+
+  InferenceArena(InferenceArena const & other) = delete;
+
+  InferenceArena & operator=(InferenceArena const & other) = delete;
+
+  ~InferenceArena();
+
+  /// @returns memory resource of the current arena of this thread or the default memory resource without arena
+  static std::pmr::memory_resource * getMemoryResource();
+
+  /// @returns memory resource of rows of the current arena of this thread or the default memory resource without arena
+  static std::pmr::memory_resource * getRowsMemoryResource();
+
+  /// @returns true if some rows of the current arena of this thread are spilled to files
+  static bool isSpilling();
+
+  /// @returns amount of bytes of rows kept in memory
+  size_t getRowsMemorySize() const
+  {
+    return rows.getMemorySize();
+  }
+
+  /// @returns amount of bytes of rows spilled to files
+  size_t getSpilledRowsMemorySize() const
+  {
+    return rows.getSpilledMemorySize();
+  }
+
+  /// @returns amount of blocks of rows spilled to files since the arena is created
+  size_t getSpilledRowsBlocksAmount() const
+  {
+    return rows.getSpilledBlocksAmount();
+  }
+
+private:
+  friend class SharedInferenceArena;
+
+  static thread_local InferenceArena * currentArena;
+  static thread_local std::pmr::memory_resource * currentMemoryResource;
+  static thread_local std::pmr::memory_resource * currentRowsMemoryResource;
+
+  std::pmr::unsynchronized_pool_resource pool;
+  SpillingMemoryResource rows;
+  // rows take small blocks from the pool, so both resources are shared under the same mutex
+  std::mutex mutex;
+  SynchronizedMemoryResource synchronizedPool;
+  SynchronizedMemoryResource synchronizedRows;
+  InferenceArena * previousArena;
+  std::pmr::memory_resource * previousMemoryResource;
+  std::pmr::memory_resource * previousRowsMemoryResource;
+};
+
+/**
+ * @brief Current arena of a thread shared with tasks of parallel loops run by the thread. While the object is alive,
+ * the thread and tasks in TaskScope allocate from the arena through synchronized resources, so rows found by tasks
+ * in any thread are accounted in the memory budget of the arena. Without arena tasks use the default memory resource
+ */
+class SharedInferenceArena
+{
+public:
+  SharedInferenceArena();
+
+  SharedInferenceArena(SharedInferenceArena const & other) = delete;
+
+  SharedInferenceArena & operator=(SharedInferenceArena const & other) = delete;
+
+  ~SharedInferenceArena();
+
+  /// Scope of a task in which the task allocates from the shared arena
+  class TaskScope
+  {
+  public:
+    explicit TaskScope(SharedInferenceArena const & sharedArena);
+
+    TaskScope(TaskScope const & other) = delete;
+
+    TaskScope & operator=(TaskScope const & other) = delete;
+
+    ~TaskScope();
+
+  private:
+    InferenceArena * previousArena;
+    std::pmr::memory_resource * previousMemoryResource;
+    std::pmr::memory_resource * previousRowsMemoryResource;
+  };
+
+private:
+  InferenceArena * arena;
+  std::pmr::memory_resource * previousMemoryResource;
+  std::pmr::memory_resource * previousRowsMemoryResource;
+};
+
+}  // namespace inference
@@ -0,0 +1,48 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "LinksContentCache.hpp"
+
+#include <algorithm>
+
+namespace inference
+{
+LinksContentCache::LinksContentCache(ScMemoryContext * context)
+  : context(context)
+{
+}
+
+bool LinksContentCache::hasContent(ScAddr const & link, std::string const & content)
+{
+  auto found = contents.find(link);
+  if (found == contents.cend())
+  {
+    // content of a link without content is empty
+    std::string linkContent;
+    context->GetLinkContent(link, linkContent);
+    found = contents.emplace(link, std::move(linkContent)).first;
+  }
+  return found->second == content;
+}
+
+ScAddrVector LinksContentCache::getLinksByContent(std::string const & content)
+{
+  // links are found by the index on each call, so links created during the run are not missed
+  ScAddrVector links = context->FindLinksByContent(content);
+  links.erase(
+      std::remove_if(
+          links.begin(),
+          links.end(),
+          [this](ScAddr const & link) {
+            return !context->GetElementType(link).IsConst();
+          }),
+      links.end());
+  for (ScAddr const & link : links)
+    contents.emplace(link, content);
+  return links;
+}
+
+}  // namespace inference
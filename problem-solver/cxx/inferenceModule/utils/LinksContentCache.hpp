@@ -0,0 +1,36 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include "sc-memory/sc_memory.hpp"
+
+namespace inference
+{
+/**
+ * @brief Cache of contents of links during an inference run, content of each link is read from sc-memory once or
+ * taken from the content index of sc-memory when the link is found by content
+ */
+class LinksContentCache
+{
+public:
+  explicit LinksContentCache(ScMemoryContext * context);
+
+  /// @returns true if the link has content equal to the given one
+  bool hasContent(ScAddr const & link, std::string const & content);
+
+  /// @returns constant links with the content found by the content index of sc-memory
+  ScAddrVector getLinksByContent(std::string const & content);
+
+private:
+  ScMemoryContext * context;
+  std::unordered_map<ScAddr, std::string, ScAddrHashFunc<uint32_t>> contents;
+};
+
+}  // namespace inference
@@ -0,0 +1,22 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ReplacementsBloomFilter.hpp"
+#include "InferenceArena.hpp"
+
+namespace inference
+{
+ReplacementsBloomFilter::ReplacementsBloomFilter(size_t expectedKeysAmount)
+  : words(InferenceArena::getRowsMemoryResource())
+{
+  // about 16 bits are reserved for each key
+  size_t wordsAmount = 1;
+  while (wordsAmount * 4 < expectedKeysAmount)
+    wordsAmount <<= 1;
+  words.assign(wordsAmount, 0);
+  wordsMask = wordsAmount - 1;
+}
+}  // namespace inference
@@ -0,0 +1,52 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace inference
+{
+/**
+ * @brief Blocked Bloom filter over hashes of replacements keys. All bits of a key are set in one 64-bit word, so
+ * checking a key reads one word. It never rejects added keys and rejects most of other keys
+ */
+class ReplacementsBloomFilter
+{
+public:
+  explicit ReplacementsBloomFilter(size_t expectedKeysAmount);
+
+  void add(uint64_t hash)
+  {
+    words[getWord(hash)] |= getMask(hash);
+  }
+
+  /// @returns false if the key with such hash was not added for sure
+  bool mayContain(uint64_t hash) const
+  {
+    uint64_t const mask = getMask(hash);
+    return (words[getWord(hash)] & mask) == mask;
+  }
+
+private:
+  std::pmr::vector<uint64_t> words;
+  uint64_t wordsMask;
+
+  size_t getWord(uint64_t hash) const
+  {
+    return (hash >> 32) & wordsMask;
+  }
+
+  static uint64_t getMask(uint64_t hash)
+  {
+    return (1ULL << (hash & 63)) | (1ULL << ((hash >> 6) & 63)) | (1ULL << ((hash >> 12) & 63));
+  }
+};
+
+}  // namespace inference
@@ -0,0 +1,38 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ReplacementsBuilder.hpp"
+
+namespace inference
+{
+ReplacementsBuilder::ReplacementsBuilder(Replacements & replacements)
+  : replacements(replacements)
+  , addedRows(replacements)
+  , firstRow(replacements.getRowsAmount())
+{
+}
+
+ScAddr * ReplacementsBuilder::addRow()
+{
+  // rows added before were taken by the consumer of replacements, so the new row is compared with later rows only
+  if (replacements.getRowsAmount() != firstRow + addedRows.getSize())
+  {
+    addedRows.clear();
+    firstRow = replacements.getRowsAmount();
+  }
+  return replacements.addRow();
+}
+
+bool ReplacementsBuilder::commitRow()
+{
+  size_t const row = replacements.getRowsAmount() - 1;
+  if (addedRows.insert(row))
+    return true;
+  replacements.truncate(row);
+  return false;
+}
+
+}  // namespace inference
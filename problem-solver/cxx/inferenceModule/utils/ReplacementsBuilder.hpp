@@ -0,0 +1,44 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include "ReplacementsRowSet.hpp"
+
+namespace inference
+{
+/**
+ * @brief Builder of replacements rows which rejects rows equal to rows it has added before. Only rows kept in the
+ * replacements are checked: if rows are taken from the replacements by their consumer, the builder forgets them
+ */
+class ReplacementsBuilder
+{
+public:
+  explicit ReplacementsBuilder(Replacements & replacements);
+
+  ReplacementsBuilder(ReplacementsBuilder const & other) = delete;
+
+  ReplacementsBuilder & operator=(ReplacementsBuilder const & other) = delete;
+
+  ScAddrVector const & getVariables() const
+  {
+    return replacements.getVariables();
+  }
+
+  /// @returns values of a new row, they are filled before `commitRow` is called
+  ScAddr * addRow();
+
+  /// Keep the row added last if no other added row has the same values, otherwise remove it
+  /// @returns true if the row is kept
+  bool commitRow();
+
+private:
+  Replacements & replacements;
+  ReplacementsRowSet addedRows;
+  size_t firstRow;
+};
+
+}  // namespace inference
@@ -0,0 +1,111 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ReplacementsCodeIndex.hpp"
+#include "InferenceArena.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace inference
+{
+namespace
+{
+uint32_t constexpr NO_CODE = UINT32_MAX;
+}  // namespace
+
+ReplacementsCodeIndex::ReplacementsCodeIndex(
+    Replacements const & indexed,
+    std::vector<size_t> const & indexedColumns,
+    Replacements const & probing,
+    std::vector<size_t> const & probingColumns)
+  : probing(probing)
+  , probingColumns(probingColumns)
+  , heads(InferenceArena::getRowsMemoryResource())
+  , next(InferenceArena::getRowsMemoryResource())
+  , keys(InferenceArena::getRowsMemoryResource())
+{
+  // dictionaries are small compared with rows, so translation of all their codes is cheap
+  uint64_t multiplier = 1;
+  std::unordered_map<ScAddr, uint32_t, ScAddrHashFunc<uint32_t>> indexedCodes;
+  for (size_t index = 0; index < indexedColumns.size(); ++index)
+  {
+    std::pmr::vector<ScAddr> const & indexedDictionary = indexed.getDictionaryColumn(indexedColumns[index]).dictionary;
+    multipliers.push_back(multiplier);
+    multiplier *= indexedDictionary.size();
+
+    indexedCodes.clear();
+    for (size_t code = 0; code < indexedDictionary.size(); ++code)
+      indexedCodes.emplace(indexedDictionary[code], static_cast<uint32_t>(code));
+    std::pmr::vector<ScAddr> const & probingDictionary = probing.getDictionaryColumn(probingColumns[index]).dictionary;
+    std::vector<uint32_t> & translation = translations.emplace_back(probingDictionary.size(), NO_CODE);
+    for (size_t code = 0; code < probingDictionary.size(); ++code)
+    {
+      auto const & indexedCode = indexedCodes.find(probingDictionary[code]);
+      if (indexedCode != indexedCodes.cend())
+        translation[code] = indexedCode->second;
+    }
+  }
+
+  size_t const rowsAmount = indexed.getRowsAmount();
+  keys.assign(rowsAmount, 0);
+  for (size_t index = 0; index < indexedColumns.size(); ++index)
+  {
+    Replacements::DictionaryColumn const & dictionaryColumn = indexed.getDictionaryColumn(indexedColumns[index]);
+    for (size_t row = 0; row < rowsAmount; ++row)
+      keys[row] += dictionaryColumn.getCode(row) * multipliers[index];
+  }
+
+  size_t bucketBits = 1;
+  while ((size_t(1) << bucketBits) < rowsAmount * 2)
+    ++bucketBits;
+  bucketShift = 64 - bucketBits;
+  heads.assign(size_t(1) << bucketBits, npos);
+  next.resize(rowsAmount);
+  // rows are linked from the last one, so rows with equal keys are found in ascending order
+  for (size_t row = rowsAmount; row-- > 0;)
+  {
+    size_t & head = heads[getBucket(keys[row])];
+    next[row] = head;
+    head = row;
+  }
+}
+
+bool ReplacementsCodeIndex::isApplicable(Replacements const & indexed, std::vector<size_t> const & indexedColumns)
+{
+  if (!indexed.isCompressed())
+    return false;
+  // the greatest key is less than the product of dictionary sizes, so the product should fit to 64 bits
+  uint64_t keysAmount = 1;
+  for (size_t const column : indexedColumns)
+  {
+    uint64_t const dictionarySize = indexed.getDictionaryColumn(column).dictionary.size();
+    if (keysAmount > UINT64_MAX / dictionarySize)
+      return false;
+    keysAmount *= dictionarySize;
+  }
+  return true;
+}
+
+void ReplacementsCodeIndex::getProbingKeys(size_t beginRow, size_t endRow, uint64_t * keys) const
+{
+  std::fill(keys, keys + (endRow - beginRow), 0);
+  for (size_t index = 0; index < probingColumns.size(); ++index)
+  {
+    Replacements::DictionaryColumn const & dictionaryColumn = probing.getDictionaryColumn(probingColumns[index]);
+    std::vector<uint32_t> const & translation = translations[index];
+    for (size_t row = beginRow; row < endRow; ++row)
+    {
+      uint64_t & key = keys[row - beginRow];
+      if (key == NO_KEY)
+        continue;
+      uint32_t const code = translation[dictionaryColumn.getCode(row)];
+      key = code == NO_CODE ? NO_KEY : key + code * multipliers[index];
+    }
+  }
+}
+
+}  // namespace inference
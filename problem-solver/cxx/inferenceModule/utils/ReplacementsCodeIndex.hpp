@@ -0,0 +1,80 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "ReplacementsTable.hpp"
+
+namespace inference
+{
+/**
+ * @brief Index over rows of compressed replacements by dictionary codes of key columns, probed by rows of other
+ * compressed replacements. Codes of key columns of a row are combined to one number like digits with dictionary sizes
+ * as bases, and codes of probing rows are translated to codes of indexed rows through their dictionaries, so keys are
+ * compared as numbers and rows of both replacements are not decoded
+ */
+class ReplacementsCodeIndex
+{
+public:
+  static size_t constexpr npos = SIZE_MAX;
+  /// Key of probing row with a value absent in dictionaries of the indexed replacements
+  static uint64_t constexpr NO_KEY = UINT64_MAX;
+
+  ReplacementsCodeIndex(
+      Replacements const & indexed,
+      std::vector<size_t> const & indexedColumns,
+      Replacements const & probing,
+      std::vector<size_t> const & probingColumns);
+
+  /// @returns true if both replacements are compressed and codes of key columns of the `indexed` fit to 64-bit keys
+  static bool isApplicable(Replacements const & indexed, std::vector<size_t> const & indexedColumns);
+
+  /// Write keys of rows of the probing replacements from `beginRow` to `endRow`, `NO_KEY` for rows without matches
+  void getProbingKeys(size_t beginRow, size_t endRow, uint64_t * keys) const;
+
+  /// @returns first indexed row with the given key or `npos`
+  size_t findFirst(uint64_t key) const
+  {
+    return findFrom(heads[getBucket(key)], key);
+  }
+
+  /// @returns next indexed row after the given one with the same key or `npos`
+  size_t findNext(size_t row, uint64_t key) const
+  {
+    return findFrom(next[row], key);
+  }
+
+private:
+  Replacements const & probing;
+  std::vector<size_t> probingColumns;
+  /// bases of digits of keys for each key column
+  std::vector<uint64_t> multipliers;
+  /// codes of the indexed replacements for each code of each key column of the probing replacements
+  std::vector<std::vector<uint32_t>> translations;
+  /// keys are hashed by Fibonacci hashing, buckets are numbered by high bits of products
+  size_t bucketShift;
+  std::pmr::vector<size_t> heads;
+  std::pmr::vector<size_t> next;
+  std::pmr::vector<uint64_t> keys;
+
+  size_t getBucket(uint64_t key) const
+  {
+    return (key * 0x9e3779b97f4a7c15ULL) >> bucketShift;
+  }
+
+  size_t findFrom(size_t row, uint64_t key) const
+  {
+    while (row != npos && keys[row] != key)
+      row = next[row];
+    return row;
+  }
+};
+
+}  // namespace inference
@@ -0,0 +1,229 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ReplacementsGenericJoin.hpp"
+#include "InferenceArena.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+namespace inference
+{
+namespace
+{
+/// @returns value packed to an integer ordered by segment and then by offset
+uint64_t packValue(ScAddr const & value)
+{
+  sc_addr const & addr = value.GetRealAddr();
+  return (static_cast<uint64_t>(addr.seg) << 32) | static_cast<uint64_t>(addr.offset);
+}
+
+ScAddr unpackValue(uint64_t value)
+{
+  sc_addr addr;
+  addr.seg = static_cast<decltype(addr.seg)>(value >> 32);
+  addr.offset = static_cast<decltype(addr.offset)>(value & UINT32_MAX);
+  return ScAddr(addr);
+}
+}  // namespace
+
+ReplacementsGenericJoin::Trie::Trie(std::pmr::memory_resource * memoryResource)
+  : values(memoryResource)
+{
+}
+
+ReplacementsGenericJoin::ReplacementsGenericJoin(std::vector<Replacements> const & replacementsVector)
+{
+  orderVariables(replacementsVector);
+  levels.resize(variables.size());
+  for (Replacements const & replacements : replacementsVector)
+  {
+    // replacements without variables do not restrict the join unless they have no rows
+    if (replacements.getColumnsAmount() == 0)
+    {
+      isEmpty |= replacements.empty();
+      continue;
+    }
+    addTrie(replacements);
+    isEmpty |= tries.back().rowsAmount == 0;
+  }
+  binding.resize(variables.size());
+}
+
+Replacements ReplacementsGenericJoin::getResult()
+{
+  Replacements result(variables);
+  if (isEmpty || tries.empty())
+    return result;
+
+  ranges.clear();
+  for (Trie const & trie : tries)
+    ranges.push_back({0, trie.rowsAmount});
+  join(0, result);
+  return result;
+}
+
+void ReplacementsGenericJoin::orderVariables(std::vector<Replacements> const & replacementsVector)
+{
+  // variables shared by more replacements are bound first, so they cut candidate rows of more tries at once
+  std::unordered_map<ScAddr, size_t, ScAddrHashFunc<uint32_t>> occurrences;
+  for (Replacements const & replacements : replacementsVector)
+  {
+    for (ScAddr const & variable : replacements.getVariables())
+    {
+      if (occurrences[variable]++ == 0)
+        variables.push_back(variable);
+    }
+  }
+  std::stable_sort(variables.begin(), variables.end(), [&occurrences](ScAddr const & first, ScAddr const & second) {
+    return occurrences[first] > occurrences[second];
+  });
+}
+
+void ReplacementsGenericJoin::addTrie(Replacements const & replacements)
+{
+  size_t const trieIndex = tries.size();
+  Trie & trie = tries.emplace_back(InferenceArena::getRowsMemoryResource());
+  std::vector<size_t> columns;
+  for (size_t depth = 0; depth < variables.size(); ++depth)
+  {
+    size_t const column = replacements.getColumnIndex(variables[depth]);
+    if (column == Replacements::npos)
+      continue;
+    levels[depth].push_back({trieIndex, columns.size()});
+    columns.push_back(column);
+  }
+  trie.columnsAmount = columns.size();
+
+  size_t const rowsAmount = replacements.getRowsAmount();
+  std::pmr::vector<uint64_t> values(rowsAmount * columns.size(), InferenceArena::getRowsMemoryResource());
+  for (size_t row = 0; row < rowsAmount; ++row)
+  {
+    for (size_t column = 0; column < columns.size(); ++column)
+      values[row * columns.size() + column] = packValue(replacements.get(row, columns[column]));
+  }
+
+  size_t const columnsAmount = columns.size();
+  auto const & getRowBegin = [&values, columnsAmount](size_t row) {
+    return values.cbegin() + row * columnsAmount;
+  };
+  auto const & isRowLess = [&getRowBegin, columnsAmount](size_t first, size_t second) {
+    auto const & firstBegin = getRowBegin(first);
+    auto const & secondBegin = getRowBegin(second);
+    return std::lexicographical_compare(
+        firstBegin, firstBegin + columnsAmount, secondBegin, secondBegin + columnsAmount);
+  };
+  std::vector<size_t> rows(rowsAmount);
+  std::iota(rows.begin(), rows.end(), 0);
+  std::sort(rows.begin(), rows.end(), isRowLess);
+
+  trie.values.reserve(values.size());
+  for (size_t index = 0; index < rows.size(); ++index)
+  {
+    // equal rows are adjacent after sorting
+    if (index > 0 && !isRowLess(rows[index - 1], rows[index]))
+      continue;
+    trie.values.insert(trie.values.cend(), getRowBegin(rows[index]), getRowBegin(rows[index]) + columnsAmount);
+    ++trie.rowsAmount;
+  }
+}
+
+size_t ReplacementsGenericJoin::seekLowerBound(TrieLevel const & level, size_t begin, size_t end, uint64_t value) const
+{
+  // values of bound variables are searched in ascending order, so the next one is usually close to the previous one
+  size_t step = 1;
+  size_t low = begin;
+  while (begin + step < end && getValue(level, begin + step - 1) < value)
+  {
+    low = begin + step;
+    step <<= 1;
+  }
+  size_t high = std::min(begin + step, end);
+  while (low < high)
+  {
+    size_t const middle = low + (high - low) / 2;
+    if (getValue(level, middle) < value)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  return low;
+}
+
+size_t ReplacementsGenericJoin::seekUpperBound(TrieLevel const & level, size_t begin, size_t end, uint64_t value) const
+{
+  return value == UINT64_MAX ? end : seekLowerBound(level, begin, end, value + 1);
+}
+
+void ReplacementsGenericJoin::join(size_t depth, Replacements & result)
+{
+  if (depth == variables.size())
+  {
+    ScAddr * row = result.addRow();
+    for (size_t column = 0; column < binding.size(); ++column)
+      row[column] = unpackValue(binding[column]);
+    return;
+  }
+
+  std::vector<TrieLevel> const & depthLevels = levels[depth];
+  std::vector<Range> depthRanges;
+  depthRanges.reserve(depthLevels.size());
+  for (TrieLevel const & level : depthLevels)
+    depthRanges.push_back(ranges[level.trie]);
+  // candidate values are taken from the trie with the fewest rows and looked up in the others
+  size_t const leader = std::min_element(
+                            depthRanges.cbegin(),
+                            depthRanges.cend(),
+                            [](Range const & first, Range const & second) {
+                              return first.end - first.begin < second.end - second.begin;
+                            }) -
+                        depthRanges.cbegin();
+  std::vector<size_t> cursors(depthLevels.size());
+  for (size_t index = 0; index < depthLevels.size(); ++index)
+    cursors[index] = depthRanges[index].begin;
+
+  TrieLevel const & leaderLevel = depthLevels[leader];
+  size_t const leaderEnd = depthRanges[leader].end;
+  while (cursors[leader] < leaderEnd)
+  {
+    uint64_t const value = getValue(leaderLevel, cursors[leader]);
+    bool isFound = true;
+    for (size_t index = 0; index < depthLevels.size() && isFound; ++index)
+    {
+      if (index == leader)
+        continue;
+      cursors[index] = seekLowerBound(depthLevels[index], cursors[index], depthRanges[index].end, value);
+      if (cursors[index] == depthRanges[index].end)
+      {
+        cursors[leader] = leaderEnd;
+        isFound = false;
+      }
+      else if (getValue(depthLevels[index], cursors[index]) != value)
+      {
+        // the leader skips all values less than the next value of this trie
+        cursors[leader] = seekLowerBound(
+            leaderLevel, cursors[leader], leaderEnd, getValue(depthLevels[index], cursors[index]));
+        isFound = false;
+      }
+    }
+    if (!isFound)
+      continue;
+
+    for (size_t index = 0; index < depthLevels.size(); ++index)
+    {
+      size_t const runEnd = seekUpperBound(depthLevels[index], cursors[index], depthRanges[index].end, value);
+      ranges[depthLevels[index].trie] = {cursors[index], runEnd};
+      cursors[index] = runEnd;
+    }
+    binding[depth] = value;
+    join(depth + 1, result);
+  }
+
+  for (size_t index = 0; index < depthLevels.size(); ++index)
+    ranges[depthLevels[index].trie] = depthRanges[index];
+}
+}  // namespace inference
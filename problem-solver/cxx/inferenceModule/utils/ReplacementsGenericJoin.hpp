@@ -0,0 +1,83 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include <sc-memory/sc_addr.hpp>
+
+#include "ReplacementsTable.hpp"
+
+namespace inference
+{
+/**
+ * @brief Worst-case optimal join of many replacements at once. Each replacements are stored as a trie: rows sorted by
+ * values of variables in the common variable order. Variables are bound one by one, values of a variable are taken
+ * from the trie with the fewest candidate rows and are looked up in other tries by galloping search, so no pairwise
+ * intermediate result is built and cyclic joins do not grow beyond the size of their output
+ */
+class ReplacementsGenericJoin
+{
+public:
+  explicit ReplacementsGenericJoin(std::vector<Replacements> const & replacementsVector);
+
+  /// @returns unique rows with values of all variables of joined replacements that agree with rows of each of them
+  Replacements getResult();
+
+private:
+  /// Rows of one replacements with columns in the common variable order, sorted and without duplicates
+  struct Trie
+  {
+    explicit Trie(std::pmr::memory_resource * memoryResource);
+
+    size_t columnsAmount = 0;
+    size_t rowsAmount = 0;
+    std::pmr::vector<uint64_t> values;
+  };
+
+  /// Trie with a variable and the column of its values in the trie
+  struct TrieLevel
+  {
+    size_t trie;
+    size_t column;
+  };
+
+  /// Rows of a trie with the same values of already bound variables
+  struct Range
+  {
+    size_t begin;
+    size_t end;
+  };
+
+  ScAddrVector variables;
+  std::vector<Trie> tries;
+  std::vector<std::vector<TrieLevel>> levels;
+  std::vector<Range> ranges;
+  std::vector<uint64_t> binding;
+  bool isEmpty = false;
+
+  uint64_t getValue(TrieLevel const & level, size_t row) const
+  {
+    Trie const & trie = tries[level.trie];
+    return trie.values[row * trie.columnsAmount + level.column];
+  }
+
+  /// @returns first row of the range starting from `begin` with value not less than the given one
+  size_t seekLowerBound(TrieLevel const & level, size_t begin, size_t end, uint64_t value) const;
+
+  /// @returns first row of the range starting from `begin` with value greater than the given one
+  size_t seekUpperBound(TrieLevel const & level, size_t begin, size_t end, uint64_t value) const;
+
+  void orderVariables(std::vector<Replacements> const & replacementsVector);
+
+  void addTrie(Replacements const & replacements);
+
+  void join(size_t depth, Replacements & result);
+};
+}  // namespace inference
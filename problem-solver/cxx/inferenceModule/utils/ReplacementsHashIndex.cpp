@@ -0,0 +1,123 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ReplacementsHashIndex.hpp"
+#include "InferenceArena.hpp"
+#include "ReplacementsKernels.hpp"
+
+namespace inference
+{
+namespace
+{
+uint64_t mix(uint64_t value)
+{
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33;
+  return value;
+}
+}  // namespace
+
+ReplacementsHashIndex::ReplacementsHashIndex(Replacements const & replacements, std::vector<size_t> const & keyColumns)
+  : keySize(keyColumns.size())
+  , heads(InferenceArena::getRowsMemoryResource())
+  , next(InferenceArena::getRowsMemoryResource())
+  , hashes(InferenceArena::getRowsMemoryResource())
+  , keys(InferenceArena::getRowsMemoryResource())
+{
+  size_t const rowsAmount = replacements.getRowsAmount();
+  allocate(rowsAmount);
+  packKeys(replacements, 0, rowsAmount, keyColumns, keys.data(), hashes.data());
+  linkRows();
+}
+
+ReplacementsHashIndex::ReplacementsHashIndex(
+    Replacements const & replacements,
+    std::vector<size_t> const & keyColumns,
+    std::pmr::vector<size_t> const & rows)
+  : keySize(keyColumns.size())
+  , heads(InferenceArena::getRowsMemoryResource())
+  , next(InferenceArena::getRowsMemoryResource())
+  , hashes(InferenceArena::getRowsMemoryResource())
+  , keys(InferenceArena::getRowsMemoryResource())
+{
+  allocate(rows.size());
+  for (size_t index = 0; index < rows.size(); ++index)
+    packKey(replacements, rows[index], keyColumns, keys.data() + index * keySize);
+  ReplacementsKernels::hashKeys(keys.data(), keySize, rows.size(), hashes.data());
+  linkRows();
+}
+
+uint64_t ReplacementsHashIndex::hashKey(ScAddr const * key, size_t keySize)
+{
+  uint64_t hash = 0x9e3779b97f4a7c15ULL;
+  for (size_t index = 0; index < keySize; ++index)
+  {
+    sc_addr const & value = key[index].GetRealAddr();
+    uint64_t const packed = (static_cast<uint64_t>(value.seg) << 32) | static_cast<uint64_t>(value.offset);
+    hash = mix(hash ^ (packed + index));
+  }
+  return hash;
+}
+
+void ReplacementsHashIndex::packKey(
+    Replacements const & replacements,
+    size_t row,
+    std::vector<size_t> const & keyColumns,
+    ScAddr * key)
+{
+  for (size_t const keyColumn : keyColumns)
+    *key++ = replacements.get(row, keyColumn);
+}
+
+void ReplacementsHashIndex::packKeys(
+    Replacements const & replacements,
+    size_t beginRow,
+    size_t endRow,
+    std::vector<size_t> const & keyColumns,
+    ScAddr * keys,
+    uint64_t * hashes)
+{
+  for (size_t row = beginRow; row < endRow; ++row)
+    packKey(replacements, row, keyColumns, keys + (row - beginRow) * keyColumns.size());
+  ReplacementsKernels::hashKeys(keys, keyColumns.size(), endRow - beginRow, hashes);
+}
+
+void ReplacementsHashIndex::allocate(size_t rowsAmount)
+{
+  size_t bucketsAmount = 1;
+  while (bucketsAmount < rowsAmount * 2)
+    bucketsAmount <<= 1;
+  mask = bucketsAmount - 1;
+  heads.assign(bucketsAmount, npos);
+  next.resize(rowsAmount);
+  hashes.resize(rowsAmount);
+  keys.resize(rowsAmount * keySize);
+}
+
+void ReplacementsHashIndex::linkRows()
+{
+  // rows are chained in reverse order so lookups return rows in the order of the indexed table
+  for (size_t row = hashes.size(); row-- > 0;)
+  {
+    size_t & head = heads[hashes[row] & mask];
+    next[row] = head;
+    head = row;
+  }
+}
+
+size_t ReplacementsHashIndex::findFrom(size_t row, ScAddr const * key, uint64_t hash) const
+{
+  for (; row != npos; row = next[row])
+  {
+    if (hashes[row] == hash && ReplacementsKernels::areKeysEqual(key, keys.data() + row * keySize, keySize))
+      return row;
+  }
+  return npos;
+}
+}  // namespace inference
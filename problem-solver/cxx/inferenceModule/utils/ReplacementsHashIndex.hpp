@@ -0,0 +1,95 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include <sc-memory/sc_addr.hpp>
+
+#include "ReplacementsTable.hpp"
+
+namespace inference
+{
+/**
+ * @brief Hash index over rows of replacements by values of key columns. Keys of all indexed rows are packed into one
+ * buffer and rows with the same bucket are chained through flat arrays, so building and probing the index does not
+ * allocate per row and compares keys without addressing the indexed table
+ */
+class ReplacementsHashIndex
+{
+public:
+  static size_t constexpr npos = SIZE_MAX;
+
+  ReplacementsHashIndex(Replacements const & replacements, std::vector<size_t> const & keyColumns);
+
+  /// Index only the given rows of replacements, found rows are positions in `rows` instead of rows of replacements
+  ReplacementsHashIndex(
+      Replacements const & replacements,
+      std::vector<size_t> const & keyColumns,
+      std::pmr::vector<size_t> const & rows);
+
+  /// @returns 64-bit hash mixing segment and offset of each key value
+  static uint64_t hashKey(ScAddr const * key, size_t keySize);
+
+  /// Pack values of key columns of the row to the key buffer
+  static void packKey(
+      Replacements const & replacements,
+      size_t row,
+      std::vector<size_t> const & keyColumns,
+      ScAddr * key);
+
+  /// Pack keys of rows from `beginRow` to `endRow` one after another and hash all of them at once
+  static void packKeys(
+      Replacements const & replacements,
+      size_t beginRow,
+      size_t endRow,
+      std::vector<size_t> const & keyColumns,
+      ScAddr * keys,
+      uint64_t * hashes);
+
+  /// @returns first indexed row with the given key or `npos`
+  size_t findFirst(ScAddr const * key, uint64_t hash) const
+  {
+    return findFrom(heads[hash & mask], key, hash);
+  }
+
+  /// @returns next indexed row after the given one with the same key or `npos`
+  size_t findNext(size_t row, ScAddr const * key, uint64_t hash) const
+  {
+    return findFrom(next[row], key, hash);
+  }
+
+  size_t getKeySize() const
+  {
+    return keySize;
+  }
+
+  /// @returns hashes of keys of all indexed rows
+  std::pmr::vector<uint64_t> const & getHashes() const
+  {
+    return hashes;
+  }
+
+private:
+  size_t keySize;
+  uint64_t mask;
+  // arrays take memory proportional to indexed rows, so they are allocated as rows of replacements
+  std::pmr::vector<size_t> heads;
+  std::pmr::vector<size_t> next;
+  std::pmr::vector<uint64_t> hashes;
+  std::pmr::vector<ScAddr> keys;
+
+  void allocate(size_t rowsAmount);
+
+  void linkRows();
+
+  size_t findFrom(size_t row, ScAddr const * key, uint64_t hash) const;
+};
+
+}  // namespace inference
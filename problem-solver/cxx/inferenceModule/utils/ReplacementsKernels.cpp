@@ -0,0 +1,225 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ReplacementsKernels.hpp"
+#include "ReplacementsHashIndex.hpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#  define INFERENCE_X86_KERNELS
+#  include <immintrin.h>
+#endif
+
+namespace inference
+{
+namespace
+{
+// values are compared and hashed as 32-bit words: segment in the low half and offset in the high half
+static_assert(sizeof(ScAddr) == sizeof(uint32_t), "ScAddr should be packed to 32 bits");
+
+using AreKeysEqualKernel = bool (*)(ScAddr const *, ScAddr const *, size_t);
+using HashKeysKernel = void (*)(ScAddr const *, size_t, size_t, uint64_t *);
+
+bool areKeysEqualScalar(ScAddr const * first, ScAddr const * second, size_t keySize)
+{
+  return std::equal(first, first + keySize, second);
+}
+
+void hashKeysScalar(ScAddr const * keys, size_t keySize, size_t keysAmount, uint64_t * hashes)
+{
+  for (size_t key = 0; key < keysAmount; ++key)
+    hashes[key] = ReplacementsHashIndex::hashKey(keys + key * keySize, keySize);
+}
+
+#ifdef INFERENCE_X86_KERNELS
+__attribute__((target("sse4.1"))) bool areKeysEqualSse41(ScAddr const * first, ScAddr const * second, size_t keySize)
+{
+  size_t index = 0;
+  for (; index + 4 <= keySize; index += 4)
+  {
+    __m128i const firstValues = _mm_loadu_si128(reinterpret_cast<__m128i const *>(first + index));
+    __m128i const secondValues = _mm_loadu_si128(reinterpret_cast<__m128i const *>(second + index));
+    if (!_mm_test_all_ones(_mm_cmpeq_epi32(firstValues, secondValues)))
+      return false;
+  }
+  return std::equal(first + index, first + keySize, second + index);
+}
+
+/// Multiply 64-bit lanes by the constant, SSE4.1 has only 32-bit to 64-bit multiplication
+__attribute__((target("sse4.1"))) __m128i multiplySse41(__m128i values, uint64_t factor)
+{
+  __m128i const factors = _mm_set1_epi64x(static_cast<int64_t>(factor));
+  __m128i const low = _mm_mul_epu32(values, factors);
+  __m128i const cross = _mm_add_epi64(
+      _mm_mul_epu32(_mm_srli_epi64(values, 32), factors), _mm_mul_epu32(values, _mm_srli_epi64(factors, 32)));
+  return _mm_add_epi64(low, _mm_slli_epi64(cross, 32));
+}
+
+__attribute__((target("sse4.1"))) __m128i mixSse41(__m128i values)
+{
+  values = _mm_xor_si128(values, _mm_srli_epi64(values, 33));
+  values = multiplySse41(values, 0xff51afd7ed558ccdULL);
+  values = _mm_xor_si128(values, _mm_srli_epi64(values, 33));
+  values = multiplySse41(values, 0xc4ceb9fe1a85ec53ULL);
+  return _mm_xor_si128(values, _mm_srli_epi64(values, 33));
+}
+
+/// @returns packed values of the key value at `index` of two keys starting from `keys`, SSE4.1 has no gather
+__attribute__((target("sse4.1"))) __m128i loadValuesSse41(ScAddr const * keys, size_t keySize, size_t index)
+{
+  auto const & pack = [index](ScAddr const & value) {
+    sc_addr const & realAddr = value.GetRealAddr();
+    return static_cast<int64_t>(
+        ((static_cast<uint64_t>(realAddr.seg) << 32) | static_cast<uint64_t>(realAddr.offset)) + index);
+  };
+  return _mm_set_epi64x(pack(keys[keySize + index]), pack(keys[index]));
+}
+
+/// Hash four keys at once in two independent vectors, each 64-bit lane holds the hash of one key
+__attribute__((target("sse4.1"))) void hashKeysSse41(
+    ScAddr const * keys,
+    size_t keySize,
+    size_t keysAmount,
+    uint64_t * hashes)
+{
+  size_t key = 0;
+  for (; key + 4 <= keysAmount; key += 4)
+  {
+    __m128i firstHashes = _mm_set1_epi64x(static_cast<int64_t>(0x9e3779b97f4a7c15ULL));
+    __m128i secondHashes = firstHashes;
+    for (size_t index = 0; index < keySize; ++index)
+    {
+      __m128i const firstValues = loadValuesSse41(keys + key * keySize, keySize, index);
+      __m128i const secondValues = loadValuesSse41(keys + (key + 2) * keySize, keySize, index);
+      firstHashes = mixSse41(_mm_xor_si128(firstHashes, firstValues));
+      secondHashes = mixSse41(_mm_xor_si128(secondHashes, secondValues));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(hashes + key), firstHashes);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(hashes + key + 2), secondHashes);
+  }
+  hashKeysScalar(keys + key * keySize, keySize, keysAmount - key, hashes + key);
+}
+
+__attribute__((target("avx2"))) bool areKeysEqualAvx2(ScAddr const * first, ScAddr const * second, size_t keySize)
+{
+  size_t index = 0;
+  for (; index + 8 <= keySize; index += 8)
+  {
+    __m256i const firstValues = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(first + index));
+    __m256i const secondValues = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(second + index));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(firstValues, secondValues)) != -1)
+      return false;
+  }
+  return areKeysEqualSse41(first + index, second + index, keySize - index);
+}
+
+/// Multiply 64-bit lanes by the constant, AVX2 has only 32-bit to 64-bit multiplication
+__attribute__((target("avx2"))) __m256i multiplyAvx2(__m256i values, uint64_t factor)
+{
+  __m256i const factors = _mm256_set1_epi64x(static_cast<int64_t>(factor));
+  __m256i const low = _mm256_mul_epu32(values, factors);
+  __m256i const cross = _mm256_add_epi64(
+      _mm256_mul_epu32(_mm256_srli_epi64(values, 32), factors),
+      _mm256_mul_epu32(values, _mm256_srli_epi64(factors, 32)));
+  return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+}
+
+__attribute__((target("avx2"))) __m256i mixAvx2(__m256i values)
+{
+  values = _mm256_xor_si256(values, _mm256_srli_epi64(values, 33));
+  values = multiplyAvx2(values, 0xff51afd7ed558ccdULL);
+  values = _mm256_xor_si256(values, _mm256_srli_epi64(values, 33));
+  values = multiplyAvx2(values, 0xc4ceb9fe1a85ec53ULL);
+  return _mm256_xor_si256(values, _mm256_srli_epi64(values, 33));
+}
+
+/// @returns packed values of the key value at `index` of four keys starting from `keyWords`
+__attribute__((target("avx2"))) __m256i gatherValuesAvx2(int const * keyWords, __m128i offsets, size_t index)
+{
+  __m256i const words = _mm256_cvtepu32_epi64(_mm_i32gather_epi32(keyWords + index, offsets, 4));
+  // (segment << 32) | offset + index, as in the scalar hash
+  __m256i const packed = _mm256_or_si256(
+      _mm256_slli_epi64(_mm256_and_si256(words, _mm256_set1_epi64x(0xffff)), 32), _mm256_srli_epi64(words, 16));
+  return _mm256_add_epi64(packed, _mm256_set1_epi64x(static_cast<int64_t>(index)));
+}
+
+/// Hash eight keys at once in two independent vectors, each 64-bit lane holds the hash of one key
+__attribute__((target("avx2"))) void hashKeysAvx2(
+    ScAddr const * keys,
+    size_t keySize,
+    size_t keysAmount,
+    uint64_t * hashes)
+{
+  auto const * words = reinterpret_cast<int const *>(keys);
+  __m128i const offsets = _mm_mullo_epi32(_mm_set_epi32(3, 2, 1, 0), _mm_set1_epi32(static_cast<int>(keySize)));
+  size_t key = 0;
+  for (; key + 8 <= keysAmount; key += 8)
+  {
+    __m256i firstHashes = _mm256_set1_epi64x(static_cast<int64_t>(0x9e3779b97f4a7c15ULL));
+    __m256i secondHashes = firstHashes;
+    for (size_t index = 0; index < keySize; ++index)
+    {
+      __m256i const firstValues = gatherValuesAvx2(words + key * keySize, offsets, index);
+      __m256i const secondValues = gatherValuesAvx2(words + (key + 4) * keySize, offsets, index);
+      firstHashes = mixAvx2(_mm256_xor_si256(firstHashes, firstValues));
+      secondHashes = mixAvx2(_mm256_xor_si256(secondHashes, secondValues));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(hashes + key), firstHashes);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(hashes + key + 4), secondHashes);
+  }
+  hashKeysScalar(keys + key * keySize, keySize, keysAmount - key, hashes + key);
+}
+#endif
+
+struct Kernels
+{
+  AreKeysEqualKernel areKeysEqual = areKeysEqualScalar;
+  HashKeysKernel hashKeys = hashKeysScalar;
+  std::string instructionSet = "scalar";
+};
+
+Kernels selectKernels()
+{
+  Kernels kernels;
+#ifdef INFERENCE_X86_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+  {
+    kernels.areKeysEqual = areKeysEqualAvx2;
+    kernels.hashKeys = hashKeysAvx2;
+    kernels.instructionSet = "avx2";
+  }
+  else if (__builtin_cpu_supports("sse4.1"))
+  {
+    kernels.areKeysEqual = areKeysEqualSse41;
+    kernels.hashKeys = hashKeysSse41;
+    kernels.instructionSet = "sse4.1";
+  }
+#endif
+  return kernels;
+}
+
+Kernels const & getKernels()
+{
+  static Kernels const kernels = selectKernels();
+  return kernels;
+}
+}  // namespace
+
+void ReplacementsKernels::hashKeys(ScAddr const * keys, size_t keySize, size_t keysAmount, uint64_t * hashes)
+{
+  getKernels().hashKeys(keys, keySize, keysAmount, hashes);
+}
+
+std::string ReplacementsKernels::getInstructionSet()
+{
+  return getKernels().instructionSet;
+}
+
+bool ReplacementsKernels::areLongKeysEqual(ScAddr const * first, ScAddr const * second, size_t keySize)
+{
+  return getKernels().areKeysEqual(first, second, keySize);
+}
+}  // namespace inference
@@ -0,0 +1,50 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <sc-memory/sc_addr.hpp>
+
+namespace inference
+{
+/**
+ * @brief Kernels of replacements joins over packed ScAddr values: comparison of keys and hashing of keys of many rows.
+ * AVX2 or SSE4.1 kernels are chosen at runtime by the instruction set of the processor and scalar kernels are used
+ * on other processors and platforms. All kernels give the same results
+ */
+class ReplacementsKernels
+{
+public:
+  /// Least amount of key values to compare them by vector kernels, shorter keys are compared in place
+  static size_t constexpr VECTOR_KEY_MIN_SIZE = 4;
+
+  /// @returns true if both keys have the same values
+  static bool areKeysEqual(ScAddr const * first, ScAddr const * second, size_t keySize)
+  {
+    if (keySize < VECTOR_KEY_MIN_SIZE)
+      return std::equal(first, first + keySize, second);
+    return areLongKeysEqual(first, second, keySize);
+  }
+
+  /**
+   * @brief Hash keys packed one after another, each hash is equal to `ReplacementsHashIndex::hashKey` of the key
+   * @param keys values of `keysAmount` keys of `keySize` values each
+   * @param hashes buffer for `keysAmount` hashes
+   */
+  static void hashKeys(ScAddr const * keys, size_t keySize, size_t keysAmount, uint64_t * hashes);
+
+  /// @returns name of the instruction set of chosen kernels: "avx2", "sse4.1" or "scalar"
+  static std::string getInstructionSet();
+
+private:
+  static bool areLongKeysEqual(ScAddr const * first, ScAddr const * second, size_t keySize);
+};
+}  // namespace inference
@@ -0,0 +1,84 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ReplacementsRowSet.hpp"
+#include "InferenceArena.hpp"
+#include "ReplacementsHashIndex.hpp"
+#include "ReplacementsKernels.hpp"
+
+#include <algorithm>
+
+namespace inference
+{
+ReplacementsRowSet::ReplacementsRowSet(Replacements const & replacements, size_t expectedRowsAmount)
+  : replacements(replacements)
+  , slots(InferenceArena::getRowsMemoryResource())
+  , slotHashes(InferenceArena::getRowsMemoryResource())
+{
+  size_t slotsAmount = 16;
+  while (slotsAmount < expectedRowsAmount * 2)
+    slotsAmount <<= 1;
+  rehash(slotsAmount);
+}
+
+bool ReplacementsRowSet::insert(size_t row)
+{
+  // the load factor is kept not greater than 1/2
+  if ((size + 1) * 2 > slots.size())
+    rehash(slots.size() * 2);
+
+  uint64_t const hash =
+      ReplacementsHashIndex::hashKey(replacements.getRow(row).begin(), replacements.getColumnsAmount());
+  size_t const slot = findSlot(row, hash);
+  if (slots[slot] != EMPTY_SLOT)
+    return false;
+  slots[slot] = row;
+  slotHashes[slot] = hash;
+  ++size;
+  return true;
+}
+
+void ReplacementsRowSet::clear()
+{
+  std::fill(slots.begin(), slots.end(), EMPTY_SLOT);
+  size = 0;
+}
+
+void ReplacementsRowSet::rehash(size_t slotsAmount)
+{
+  std::pmr::vector<size_t> const previousSlots = std::move(slots);
+  std::pmr::vector<uint64_t> const previousSlotHashes = std::move(slotHashes);
+  slots.assign(slotsAmount, EMPTY_SLOT);
+  slotHashes.assign(slotsAmount, 0);
+  size_t const mask = slotsAmount - 1;
+  for (size_t previousSlot = 0; previousSlot < previousSlots.size(); ++previousSlot)
+  {
+    if (previousSlots[previousSlot] == EMPTY_SLOT)
+      continue;
+    size_t slot = previousSlotHashes[previousSlot] & mask;
+    while (slots[slot] != EMPTY_SLOT)
+      slot = (slot + 1) & mask;
+    slots[slot] = previousSlots[previousSlot];
+    slotHashes[slot] = previousSlotHashes[previousSlot];
+  }
+}
+
+size_t ReplacementsRowSet::findSlot(size_t row, uint64_t hash) const
+{
+  size_t const mask = slots.size() - 1;
+  Replacements::Row const & values = replacements.getRow(row);
+  size_t slot = hash & mask;
+  for (; slots[slot] != EMPTY_SLOT; slot = (slot + 1) & mask)
+  {
+    if (slotHashes[slot] != hash)
+      continue;
+    Replacements::Row const & slotValues = replacements.getRow(slots[slot]);
+    if (ReplacementsKernels::areKeysEqual(values.begin(), slotValues.begin(), values.getSize()))
+      break;
+  }
+  return slot;
+}
+}  // namespace inference
@@ -0,0 +1,50 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "ReplacementsTable.hpp"
+
+namespace inference
+{
+/**
+ * @brief Set of distinct rows of replacements. Rows are stored as indices in an open addressing table together with
+ * hashes of their values, so inserting a row does not allocate unless the set grows and rows are compared only on
+ * hash hit
+ */
+class ReplacementsRowSet
+{
+public:
+  explicit ReplacementsRowSet(Replacements const & replacements, size_t expectedRowsAmount = 0);
+
+  /// Insert the row of replacements if the set has no row with the same values
+  /// @returns true if the row was inserted
+  bool insert(size_t row);
+
+  size_t getSize() const
+  {
+    return size;
+  }
+
+  void clear();
+
+private:
+  static size_t constexpr EMPTY_SLOT = SIZE_MAX;
+
+  Replacements const & replacements;
+  std::pmr::vector<size_t> slots;
+  std::pmr::vector<uint64_t> slotHashes;
+  size_t size = 0;
+
+  void rehash(size_t slotsAmount);
+  size_t findSlot(size_t row, uint64_t hash) const;
+};
+
+}  // namespace inference
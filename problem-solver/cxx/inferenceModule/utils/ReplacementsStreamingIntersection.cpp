@@ -0,0 +1,70 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ReplacementsStreamingIntersection.hpp"
+
+#include <algorithm>
+
+namespace inference
+{
+ReplacementsStreamingIntersection::ReplacementsStreamingIntersection(Replacements const & indexed)
+  : indexed(indexed)
+{
+}
+
+void ReplacementsStreamingIntersection::addRows(Replacements const & streamed, size_t beginRow)
+{
+  if (!index)
+    prepare(streamed);
+
+  size_t const indexedColumnsAmount = indexed.getColumnsAmount();
+  for (size_t streamedRow = beginRow; streamedRow < streamed.getRowsAmount(); ++streamedRow)
+  {
+    ReplacementsHashIndex::packKey(streamed, streamedRow, streamedKeyColumns, key.data());
+    uint64_t const hash = ReplacementsHashIndex::hashKey(key.data(), key.size());
+    for (size_t indexedRow = index->findFirst(key.data(), hash); indexedRow != ReplacementsHashIndex::npos;
+         indexedRow = index->findNext(indexedRow, key.data(), hash))
+    {
+      ScAddr * row = result.addRow();
+      Replacements::Row const & indexedValues = indexed.getRow(indexedRow);
+      std::copy(indexedValues.begin(), indexedValues.end(), row);
+      for (size_t column = 0; column < streamedExclusiveColumns.size(); ++column)
+        row[indexedColumnsAmount + column] = streamed.get(streamedRow, streamedExclusiveColumns[column]);
+    }
+  }
+}
+
+Replacements ReplacementsStreamingIntersection::getResult()
+{
+  result.removeDuplicateRows();
+  return result;
+}
+
+void ReplacementsStreamingIntersection::prepare(Replacements const & streamed)
+{
+  std::vector<size_t> indexedKeyColumns;
+  ScAddrVector resultVariables = indexed.getVariables();
+  for (size_t column = 0; column < streamed.getColumnsAmount(); ++column)
+  {
+    ScAddr const & variable = streamed.getVariables()[column];
+    size_t const indexedColumn = indexed.getColumnIndex(variable);
+    if (indexedColumn == Replacements::npos)
+    {
+      streamedExclusiveColumns.push_back(column);
+      resultVariables.push_back(variable);
+    }
+    else
+    {
+      indexedKeyColumns.push_back(indexedColumn);
+      streamedKeyColumns.push_back(column);
+    }
+  }
+  // without common variables all indexed rows have the same empty key, so each streamed row is joined with all of them
+  index = std::make_unique<ReplacementsHashIndex>(indexed, indexedKeyColumns);
+  key.resize(streamedKeyColumns.size());
+  result = Replacements(resultVariables);
+}
+}  // namespace inference
@@ -0,0 +1,52 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <sc-memory/sc_addr.hpp>
+
+#include "ReplacementsHashIndex.hpp"
+#include "ReplacementsTable.hpp"
+
+namespace inference
+{
+/**
+ * @brief Hash join of replacements with rows which come one by one, e.g. from template search. Rows of the indexed
+ * replacements are indexed once and streamed rows are joined as soon as they are added, so they may be removed right
+ * after that and streamed replacements are never stored whole
+ */
+class ReplacementsStreamingIntersection
+{
+public:
+  explicit ReplacementsStreamingIntersection(Replacements const & indexed);
+
+  /// Join rows of the streamed replacements starting from the row `beginRow` with indexed rows
+  void addRows(Replacements const & streamed, size_t beginRow = 0);
+
+  /// @returns true if no streamed row is joined yet
+  bool empty() const
+  {
+    return result.empty();
+  }
+
+  /// @returns unique joined rows with variables of the indexed replacements followed by variables of streamed rows
+  Replacements getResult();
+
+private:
+  Replacements indexed;
+  std::unique_ptr<ReplacementsHashIndex> index;
+  std::vector<size_t> streamedKeyColumns;
+  std::vector<size_t> streamedExclusiveColumns;
+  ScAddrVector key;
+  Replacements result;
+
+  /// Index rows by variables common with the streamed replacements, it is done on the first added rows
+  void prepare(Replacements const & streamed);
+};
+}  // namespace inference
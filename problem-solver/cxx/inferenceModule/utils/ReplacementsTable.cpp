@@ -0,0 +1,515 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ReplacementsTable.hpp"
+#include "InferenceArena.hpp"
+#include "ReplacementsRowSet.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <sc-memory/sc_memory.hpp>
+
+namespace inference
+{
+ReplacementsTable::ReplacementsTable()
+  : data(getEmptyData())
+{
+}
+
+ReplacementsTable::ReplacementsTable(ScAddrVector const & variables)
+  : data(createData(InferenceArena::getMemoryResource(), InferenceArena::getRowsMemoryResource()))
+{
+  data->variables.reserve(variables.size());
+  for (ScAddr const & variable : variables)
+    addVariable(variable);
+}
+
+ReplacementsTable::ReplacementsTable(ScAddrHashSet const & variables)
+  : data(createData(InferenceArena::getMemoryResource(), InferenceArena::getRowsMemoryResource()))
+{
+  data->variables.reserve(variables.size());
+  for (ScAddr const & variable : variables)
+    addVariable(variable);
+}
+
+ReplacementsTable::Data::Data(
+    std::pmr::memory_resource * memoryResource,
+    std::pmr::memory_resource * rowsMemoryResource)
+  : columnIndices(memoryResource)
+  , values(rowsMemoryResource)
+  , expandedValues(rowsMemoryResource)
+{
+}
+
+ReplacementsTable::Data::Data(
+    Data const & other,
+    std::pmr::memory_resource * memoryResource,
+    std::pmr::memory_resource * rowsMemoryResource)
+  : variables(other.variables)
+  , columnIndices(other.columnIndices, memoryResource)
+  , values(other.values, rowsMemoryResource)
+  , rowsAmount(other.rowsAmount)
+  , rowGroups(other.rowGroups)
+  , expandedValues(rowsMemoryResource)
+{
+  dictionaryColumns.reserve(other.dictionaryColumns.size());
+  for (DictionaryColumn const & dictionaryColumn : other.dictionaryColumns)
+    dictionaryColumns.emplace_back(dictionaryColumn, memoryResource, rowsMemoryResource);
+}
+
+ReplacementsTable::DictionaryColumn::DictionaryColumn(
+    size_t codeSize,
+    std::pmr::memory_resource * memoryResource,
+    std::pmr::memory_resource * rowsMemoryResource)
+  : dictionary(memoryResource)
+  , codes(rowsMemoryResource)
+  , codeSize(codeSize)
+{
+}
+
+ReplacementsTable::DictionaryColumn::DictionaryColumn(
+    DictionaryColumn const & other,
+    std::pmr::memory_resource * memoryResource,
+    std::pmr::memory_resource * rowsMemoryResource)
+  : dictionary(other.dictionary, memoryResource)
+  , codes(other.codes, rowsMemoryResource)
+  , codeSize(other.codeSize)
+{
+}
+
+std::shared_ptr<ReplacementsTable::Data> const & ReplacementsTable::getEmptyData()
+{
+  // the empty data is shared by tables of all threads, so it is not allocated from an inference arena
+  static std::shared_ptr<Data> const emptyData =
+      createData(std::pmr::new_delete_resource(), std::pmr::new_delete_resource());
+  return emptyData;
+}
+
+std::shared_ptr<ReplacementsTable::Data> ReplacementsTable::createData(
+    std::pmr::memory_resource * memoryResource,
+    std::pmr::memory_resource * rowsMemoryResource)
+{
+  return std::allocate_shared<Data>(
+      std::pmr::polymorphic_allocator<Data>(memoryResource), memoryResource, rowsMemoryResource);
+}
+
+void ReplacementsTable::detach()
+{
+  if (data.use_count() > 1)
+  {
+    std::pmr::memory_resource * memoryResource = InferenceArena::getMemoryResource();
+    data = std::allocate_shared<Data>(
+        std::pmr::polymorphic_allocator<Data>(memoryResource),
+        *data,
+        memoryResource,
+        InferenceArena::getRowsMemoryResource());
+  }
+  else if (data->isExpanded)
+  {
+    // rows are changed, so their expanded copy is out of date
+    data->expandedValues.clear();
+    data->expandedValues.shrink_to_fit();
+    data->isExpanded = false;
+  }
+}
+
+void ReplacementsTable::addVariable(ScAddr const & variable)
+{
+  if (data->columnIndices.emplace(variable, data->variables.size()).second)
+    data->variables.push_back(variable);
+}
+
+size_t ReplacementsTable::getColumnIndex(ScAddr const & variable) const
+{
+  auto const & columnIndexIterator = data->columnIndices.find(variable);
+  return columnIndexIterator == data->columnIndices.cend() ? npos : columnIndexIterator->second;
+}
+
+void ReplacementsTable::reserve(size_t otherRowsAmount)
+{
+  expandIfUnbound();
+  detach();
+  data->values.reserve(otherRowsAmount * data->variables.size());
+}
+
+ScAddr * ReplacementsTable::addRow()
+{
+  expandIfUnbound();
+  detach();
+  data->values.resize(data->values.size() + data->variables.size());
+  ++data->rowsAmount;
+  return data->values.data() + (data->rowsAmount - 1) * data->variables.size();
+}
+
+void ReplacementsTable::addRow(Row const & row)
+{
+  if (row.getSize() != data->variables.size())
+    SC_THROW_EXCEPTION(
+        utils::ExceptionInvalidParams,
+        "Row has " << row.getSize() << " values but replacements table has " << data->variables.size()
+                   << " variables");
+  expandIfUnbound();
+  detach();
+  data->values.insert(data->values.cend(), row.begin(), row.end());
+  ++data->rowsAmount;
+}
+
+void ReplacementsTable::addRow(ScAddrVector const & row)
+{
+  addRow(Row(row.data(), row.size()));
+}
+
+void ReplacementsTable::copyRow(size_t from, size_t to)
+{
+  expandIfUnbound();
+  if (from == to)
+    return;
+  detach();
+  size_t const columnsAmount = data->variables.size();
+  std::pmr::vector<ScAddr> & values = data->values;
+  std::copy_n(values.cbegin() + from * columnsAmount, columnsAmount, values.begin() + to * columnsAmount);
+}
+
+void ReplacementsTable::truncate(size_t otherRowsAmount)
+{
+  expandIfUnbound();
+  if (otherRowsAmount >= data->rowsAmount)
+    return;
+  detach();
+  data->rowsAmount = otherRowsAmount;
+  data->values.resize(data->rowsAmount * data->variables.size());
+}
+
+void ReplacementsTable::removeDuplicateRows()
+{
+  expandIfUnbound();
+  if (data->variables.empty())
+    return;
+  // each row is moved right after the previous unique row and is kept there only if it is unique too
+  ReplacementsRowSet uniqueRows(*this, data->rowsAmount);
+  size_t uniqueRowsAmount = 0;
+  for (size_t row = 0; row < data->rowsAmount; ++row)
+  {
+    copyRow(row, uniqueRowsAmount);
+    if (uniqueRows.insert(uniqueRowsAmount))
+      ++uniqueRowsAmount;
+  }
+  truncate(uniqueRowsAmount);
+}
+
+void ReplacementsTable::expand()
+{
+  if (data->rowGroups.empty() && data->dictionaryColumns.empty())
+    return;
+  // rows are expanded to new rows of the table, compact rows are left to its copies
+  std::vector<size_t> columns(data->variables.size());
+  std::iota(columns.begin(), columns.end(), 0);
+  ReplacementsTable result(data->variables);
+  expandRows(columns, result);
+  data = std::move(result.data);
+}
+
+void ReplacementsTable::expandCopy() const
+{
+  if (data->isExpanded.load(std::memory_order_acquire))
+    return;
+  std::lock_guard<std::mutex> const lock(data->expansionMutex);
+  if (data->isExpanded.load(std::memory_order_relaxed))
+    return;
+  std::vector<size_t> columns(data->variables.size());
+  std::iota(columns.begin(), columns.end(), 0);
+  ReplacementsTable result(data->variables);
+  expandRows(columns, result);
+  data->expandedValues = std::move(result.data->values);
+  data->expandedRowsAmount = result.data->rowsAmount;
+  data->isExpanded.store(true, std::memory_order_release);
+}
+
+void ReplacementsTable::addRows(
+    ReplacementsTable const & source,
+    std::vector<size_t> const & sourceColumns,
+    UnboundColumns const & unboundColumns)
+{
+  std::vector<size_t> sourceRows(source.data->rowsAmount);
+  std::iota(sourceRows.begin(), sourceRows.end(), 0);
+  addRows(source, sourceRows, sourceColumns, unboundColumns);
+}
+
+void ReplacementsTable::addRows(
+    ReplacementsTable const & source,
+    std::vector<size_t> const & sourceRows,
+    std::vector<size_t> const & sourceColumns,
+    UnboundColumns const & unboundColumns)
+{
+  // rows of this table are changed, so they are decoded, while compressed rows of the source are read by codes
+  if (isCompressed())
+    expand();
+  detach();
+  // rows added before are put to the row group without unbound columns
+  if (data->rowsAmount > (data->rowGroups.empty() ? 0 : data->rowGroups.back().endRow))
+    data->rowGroups.push_back({data->rowsAmount, {}});
+
+  std::vector<UnboundColumns> groupUnboundColumns;
+  auto const & addRowGroup = [this, &groupUnboundColumns]() {
+    if (data->rowsAmount > (data->rowGroups.empty() ? 0 : data->rowGroups.back().endRow))
+      data->rowGroups.push_back({data->rowsAmount, groupUnboundColumns});
+  };
+
+  std::vector<RowGroup> const & sourceRowGroups = source.data->rowGroups;
+  size_t const sourceColumnsAmount = source.data->variables.size();
+  size_t sourceGroup = 0;
+  size_t currentSourceGroup = npos;
+  data->values.reserve(data->values.size() + sourceRows.size() * data->variables.size());
+  for (size_t const sourceRow : sourceRows)
+  {
+    while (sourceGroup < sourceRowGroups.size() && sourceRowGroups[sourceGroup].endRow <= sourceRow)
+      ++sourceGroup;
+    if (sourceGroup != currentSourceGroup)
+    {
+      addRowGroup();
+      currentSourceGroup = sourceGroup;
+      groupUnboundColumns.clear();
+      if (sourceGroup < sourceRowGroups.size())
+      {
+        for (UnboundColumns const & sourceUnboundColumns : sourceRowGroups[sourceGroup].unboundColumns)
+        {
+          UnboundColumns mappedUnboundColumns{{}, sourceUnboundColumns.values};
+          for (size_t const sourceColumn : sourceUnboundColumns.columns)
+            mappedUnboundColumns.columns.push_back(sourceColumns[sourceColumn]);
+          groupUnboundColumns.push_back(std::move(mappedUnboundColumns));
+        }
+      }
+      if (!unboundColumns.columns.empty())
+        groupUnboundColumns.push_back(unboundColumns);
+    }
+
+    data->values.resize(data->values.size() + data->variables.size());
+    ScAddr * row = data->values.data() + data->rowsAmount++ * data->variables.size();
+    if (source.isCompressed())
+    {
+      for (size_t sourceColumn = 0; sourceColumn < sourceColumnsAmount; ++sourceColumn)
+        row[sourceColumns[sourceColumn]] = source.data->dictionaryColumns[sourceColumn].getValue(sourceRow);
+      continue;
+    }
+    ScAddr const * sourceValues = source.data->values.data() + sourceRow * sourceColumnsAmount;
+    for (size_t sourceColumn = 0; sourceColumn < sourceColumnsAmount; ++sourceColumn)
+      row[sourceColumns[sourceColumn]] = sourceValues[sourceColumn];
+  }
+  addRowGroup();
+
+  bool const hasUnboundRows =
+      std::any_of(data->rowGroups.cbegin(), data->rowGroups.cend(), [](RowGroup const & rowGroup) {
+        return !rowGroup.unboundColumns.empty();
+      });
+  if (!hasUnboundRows)
+    data->rowGroups.clear();
+}
+
+void ReplacementsTable::expandRows(std::vector<size_t> const & columns, ReplacementsTable & result) const
+{
+  // compressed rows do not have unbound columns, so they are decoded row by row
+  if (!data->dictionaryColumns.empty())
+  {
+    result.reserve(data->rowsAmount);
+    for (size_t row = 0; row < data->rowsAmount; ++row)
+    {
+      ScAddr * resultRow = result.addRow();
+      for (size_t resultColumn = 0; resultColumn < columns.size(); ++resultColumn)
+        resultRow[resultColumn] = data->dictionaryColumns[columns[resultColumn]].getValue(row);
+    }
+    return;
+  }
+
+  // unbound values of projected columns: pairs of column in unbound values and column in the result
+  struct ProjectedUnboundColumns
+  {
+    ReplacementsTable const * values;
+    std::vector<std::pair<size_t, size_t>> columns;
+  };
+
+  std::vector<size_t> resultColumns(data->variables.size(), npos);
+  for (size_t resultColumn = 0; resultColumn < columns.size(); ++resultColumn)
+    resultColumns[columns[resultColumn]] = resultColumn;
+
+  auto const & addGroupRows = [this, &columns, &resultColumns, &result](
+                                  size_t beginRow, size_t endRow, std::vector<UnboundColumns> const & unboundColumns) {
+    std::vector<ProjectedUnboundColumns> projectedUnboundColumns;
+    for (UnboundColumns const & groupUnboundColumns : unboundColumns)
+    {
+      // rows without any unbound values stand for no rows
+      if (groupUnboundColumns.values->empty())
+        return;
+      ProjectedUnboundColumns projected{groupUnboundColumns.values.get(), {}};
+      for (size_t index = 0; index < groupUnboundColumns.columns.size(); ++index)
+      {
+        size_t const resultColumn = resultColumns[groupUnboundColumns.columns[index]];
+        if (resultColumn != npos)
+          projected.columns.emplace_back(index, resultColumn);
+      }
+      if (!projected.columns.empty())
+        projectedUnboundColumns.push_back(std::move(projected));
+    }
+
+    // each row is combined with every combination of rows of unbound values like digits of a number
+    std::vector<size_t> combination(projectedUnboundColumns.size());
+    for (size_t row = beginRow; row < endRow; ++row)
+    {
+      ScAddr const * rowValues = data->values.data() + row * data->variables.size();
+      std::fill(combination.begin(), combination.end(), 0);
+      bool hasCombination = true;
+      while (hasCombination)
+      {
+        ScAddr * resultRow = result.addRow();
+        for (size_t resultColumn = 0; resultColumn < columns.size(); ++resultColumn)
+          resultRow[resultColumn] = rowValues[columns[resultColumn]];
+        for (size_t index = 0; index < projectedUnboundColumns.size(); ++index)
+        {
+          for (auto const & column : projectedUnboundColumns[index].columns)
+            resultRow[column.second] = projectedUnboundColumns[index].values->get(combination[index], column.first);
+        }
+
+        hasCombination = false;
+        for (size_t index = combination.size(); index-- > 0;)
+        {
+          if (++combination[index] < projectedUnboundColumns[index].values->getRowsAmount())
+          {
+            hasCombination = true;
+            break;
+          }
+          combination[index] = 0;
+        }
+      }
+    }
+  };
+
+  if (data->rowGroups.empty())
+  {
+    result.reserve(data->rowsAmount);
+    addGroupRows(0, data->rowsAmount, {});
+    return;
+  }
+  size_t beginRow = 0;
+  for (RowGroup const & rowGroup : data->rowGroups)
+  {
+    addGroupRows(beginRow, rowGroup.endRow, rowGroup.unboundColumns);
+    beginRow = rowGroup.endRow;
+  }
+  addGroupRows(beginRow, data->rowsAmount, {});
+  result.removeDuplicateRows();
+}
+
+void ReplacementsTable::compress()
+{
+  expandIfUnbound();
+  size_t const rowsAmount = data->rowsAmount;
+  size_t const columnsAmount = data->variables.size();
+  if (rowsAmount == 0 || columnsAmount == 0)
+    return;
+
+  // columns are encoded one by one and encoding stops as soon as it takes not less memory than values
+  std::pmr::memory_resource * memoryResource = InferenceArena::getMemoryResource();
+  std::pmr::memory_resource * rowsMemoryResource = InferenceArena::getRowsMemoryResource();
+  size_t const valuesSize = rowsAmount * columnsAmount * sizeof(ScAddr);
+  size_t compressedSize = 0;
+  std::vector<DictionaryColumn> dictionaryColumns;
+  dictionaryColumns.reserve(columnsAmount);
+  std::vector<uint32_t> codes(rowsAmount);
+  std::unordered_map<ScAddr, uint32_t, ScAddrHashFunc<uint32_t>> valueCodes;
+  for (size_t column = 0; column < columnsAmount; ++column)
+  {
+    std::pmr::vector<ScAddr> dictionary(memoryResource);
+    valueCodes.clear();
+    for (size_t row = 0; row < rowsAmount; ++row)
+    {
+      ScAddr const & value = data->values[row * columnsAmount + column];
+      auto const & valueCode = valueCodes.emplace(value, static_cast<uint32_t>(dictionary.size()));
+      if (valueCode.second)
+        dictionary.push_back(value);
+      codes[row] = valueCode.first->second;
+    }
+
+    size_t const codeSize = dictionary.size() <= (size_t(1) << 8)    ? sizeof(uint8_t)
+                            : dictionary.size() <= (size_t(1) << 16) ? sizeof(uint16_t)
+                                                                     : sizeof(uint32_t);
+    compressedSize += dictionary.size() * sizeof(ScAddr) + rowsAmount * codeSize;
+    if (compressedSize >= valuesSize)
+      return;
+    DictionaryColumn & dictionaryColumn = dictionaryColumns.emplace_back(codeSize, memoryResource, rowsMemoryResource);
+    dictionaryColumn.dictionary = std::move(dictionary);
+    dictionaryColumn.codes.resize(rowsAmount * codeSize);
+    for (size_t row = 0; row < rowsAmount; ++row)
+      dictionaryColumn.setCode(row, codes[row]);
+  }
+
+  // compressed rows are not shared with copies of the table, so their values are released if they are not used
+  std::shared_ptr<Data> compressedData = createData(memoryResource, rowsMemoryResource);
+  compressedData->variables = data->variables;
+  compressedData->columnIndices = data->columnIndices;
+  compressedData->rowsAmount = rowsAmount;
+  compressedData->dictionaryColumns = std::move(dictionaryColumns);
+  data = std::move(compressedData);
+}
+
+size_t ReplacementsTable::getMemorySize() const
+{
+  size_t memorySize = (data->values.capacity() + data->expandedValues.capacity()) * sizeof(ScAddr);
+  for (DictionaryColumn const & dictionaryColumn : data->dictionaryColumns)
+    memorySize += dictionaryColumn.dictionary.capacity() * sizeof(ScAddr) + dictionaryColumn.codes.capacity();
+  return memorySize;
+}
+
+ReplacementsTable::Column ReplacementsTable::at(ScAddr const & variable) const
+{
+  size_t const column = getColumnIndex(variable);
+  if (column == npos)
+    throw std::out_of_range("Replacements table does not have such variable");
+  return {this, column};
+}
+
+ReplacementsTable::Projection ReplacementsTable::project(ScAddrVector const & otherVariables) const
+{
+  std::vector<size_t> columns;
+  columns.reserve(otherVariables.size());
+  for (ScAddr const & variable : otherVariables)
+  {
+    size_t const column = getColumnIndex(variable);
+    if (column != npos && std::find(columns.cbegin(), columns.cend(), column) == columns.cend())
+      columns.push_back(column);
+  }
+  return {*this, std::move(columns)};
+}
+
+ReplacementsTable::Projection ReplacementsTable::projectWithout(ScAddrHashSet const & variablesToExclude) const
+{
+  std::vector<size_t> columns;
+  columns.reserve(data->variables.size());
+  for (size_t column = 0; column < data->variables.size(); ++column)
+  {
+    if (!variablesToExclude.count(data->variables[column]))
+      columns.push_back(column);
+  }
+  return {*this, std::move(columns)};
+}
+
+ReplacementsTable::Projection::Projection(ReplacementsTable const & table, std::vector<size_t> columns)
+  : table(&table)
+  , columns(std::move(columns))
+{
+  variables.reserve(this->columns.size());
+  for (size_t const column : this->columns)
+    variables.push_back(table.data->variables[column]);
+}
+
+ReplacementsTable ReplacementsTable::Projection::materialize() const
+{
+  ReplacementsTable result(variables);
+  table->expandRows(columns, result);
+  return result;
+}
+}  // namespace inference
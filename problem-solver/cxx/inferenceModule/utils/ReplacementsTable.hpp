@@ -0,0 +1,469 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <sc-memory/sc_addr.hpp>
+
+#include "Types.hpp"
+
+namespace inference
+{
+/**
+ * @brief Table of variables replacements. Each column corresponds to a variable and each row is a set of values
+ * for all variables. Variables are interned to dense column indices once, when the table is created, and all values
+ * are stored row by row in one contiguous buffer, so joins address values by (row, column) without map lookups.
+ *
+ * Rows may be split into row groups with unbound columns: such row stands for all rows with values of unbound columns
+ * taken from the rows of another table. Unbound values are stored as empty ScAddr and rows are expanded to ordinary
+ * rows on the first access to them, while projections expand only unbound columns they include.
+ *
+ * Big tables may be compressed: each column is encoded by the dictionary of its distinct values and keeps only codes
+ * of 1, 2 or 4 bytes per row. Compressed rows are decoded on the first access to them, while joins of compressed
+ * tables read codes and dictionaries of columns directly.
+ *
+ * Copies of the table share its rows until one of them is changed, so the table is passed between logic expression
+ * nodes without copying rows. Shared rows are never changed: const accessors read an expanded copy of rows built
+ * once for all copies, so copies keep compact rows and may be read by several threads at once
+ */
+class ReplacementsTable
+{
+public:
+  static size_t constexpr npos = SIZE_MAX;
+
+  /// Read-only view on values of one row
+  class Row
+  {
+  public:
+    Row(ScAddr const * values, size_t size)
+      : values(values)
+      , size(size)
+    {
+    }
+
+    ScAddr const & operator[](size_t column) const
+    {
+      return values[column];
+    }
+
+    size_t getSize() const
+    {
+      return size;
+    }
+
+    ScAddr const * begin() const
+    {
+      return values;
+    }
+
+    ScAddr const * end() const
+    {
+      return values + size;
+    }
+
+  private:
+    ScAddr const * values;
+    size_t size;
+  };
+
+  class RowIterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Row;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Row const *;
+    using reference = Row;
+
+    RowIterator(ReplacementsTable const * table, size_t row)
+      : table(table)
+      , row(row)
+    {
+    }
+
+    Row operator*() const
+    {
+      return table->getRow(row);
+    }
+
+    RowIterator & operator++()
+    {
+      ++row;
+      return *this;
+    }
+
+    bool operator==(RowIterator const & other) const
+    {
+      return row == other.row && table == other.table;
+    }
+
+    bool operator!=(RowIterator const & other) const
+    {
+      return !(*this == other);
+    }
+
+  private:
+    ReplacementsTable const * table;
+    size_t row;
+  };
+
+  /// Read-only view on values of one variable in all rows
+  class Column
+  {
+  public:
+    Column(ReplacementsTable const * table, size_t column)
+      : table(table)
+      , column(column)
+    {
+    }
+
+    ScAddr const & operator[](size_t row) const
+    {
+      return table->get(row, column);
+    }
+
+    size_t getSize() const
+    {
+      return table->getRowsAmount();
+    }
+
+  private:
+    ReplacementsTable const * table;
+    size_t column;
+  };
+
+  /// View on a subset of table columns. Rows are not copied until the projection is materialized
+  class Projection
+  {
+  public:
+    Projection(ReplacementsTable const & table, std::vector<size_t> columns);
+
+    ScAddrVector const & getVariables() const
+    {
+      return variables;
+    }
+
+    size_t getColumnsAmount() const
+    {
+      return columns.size();
+    }
+
+    size_t getRowsAmount() const
+    {
+      return table->getRowsAmount();
+    }
+
+    ScAddr const & get(size_t row, size_t column) const
+    {
+      return table->get(row, columns[column]);
+    }
+
+    /// @returns true if rows of the table have unbound columns, then its rows are expanded by all columns on access
+    bool hasUnboundColumns() const
+    {
+      return table->hasUnboundColumns();
+    }
+
+    /// Copy projected columns to a new table. Only unbound columns included to the projection are expanded
+    ReplacementsTable materialize() const;
+
+  private:
+    ReplacementsTable const * table;
+    std::vector<size_t> columns;
+    ScAddrVector variables;
+  };
+
+  /**
+   * @brief Columns which values are not bound in rows of a row group. Each such row stands for rows with values of
+   * these columns taken from every row of `values`, columns of `values` correspond to `columns` in the same order
+   */
+  struct UnboundColumns
+  {
+    std::vector<size_t> columns;
+    std::shared_ptr<ReplacementsTable const> values;
+  };
+
+  /// Rows from the end of the previous row group to `endRow` with the same unbound columns
+  struct RowGroup
+  {
+    size_t endRow;
+    std::vector<UnboundColumns> unboundColumns;
+  };
+
+  /// Values of one column encoded as indices of values in the dictionary of distinct values of the column
+  struct DictionaryColumn
+  {
+    DictionaryColumn(
+        size_t codeSize,
+        std::pmr::memory_resource * memoryResource,
+        std::pmr::memory_resource * rowsMemoryResource);
+
+    DictionaryColumn(
+        DictionaryColumn const & other,
+        std::pmr::memory_resource * memoryResource,
+        std::pmr::memory_resource * rowsMemoryResource);
+
+    std::pmr::vector<ScAddr> dictionary;
+    /// codes of values of all rows, each code takes `codeSize` bytes
+    std::pmr::vector<uint8_t> codes;
+    size_t codeSize;
+
+    uint32_t getCode(size_t row) const
+    {
+      uint8_t const * code = codes.data() + row * codeSize;
+      if (codeSize == sizeof(uint8_t))
+        return *code;
+      if (codeSize == sizeof(uint16_t))
+      {
+        uint16_t value;
+        std::memcpy(&value, code, sizeof(value));
+        return value;
+      }
+      uint32_t value;
+      std::memcpy(&value, code, sizeof(value));
+      return value;
+    }
+
+    void setCode(size_t row, uint32_t value)
+    {
+      uint8_t * code = codes.data() + row * codeSize;
+      if (codeSize == sizeof(uint8_t))
+      {
+        *code = static_cast<uint8_t>(value);
+      }
+      else if (codeSize == sizeof(uint16_t))
+      {
+        auto const shortValue = static_cast<uint16_t>(value);
+        std::memcpy(code, &shortValue, sizeof(shortValue));
+      }
+      else
+      {
+        std::memcpy(code, &value, sizeof(value));
+      }
+    }
+
+    ScAddr const & getValue(size_t row) const
+    {
+      return dictionary[getCode(row)];
+    }
+  };
+
+  ReplacementsTable();
+
+  explicit ReplacementsTable(ScAddrVector const & variables);
+
+  explicit ReplacementsTable(ScAddrHashSet const & variables);
+
+  ScAddrVector const & getVariables() const
+  {
+    return data->variables;
+  }
+
+  bool hasVariable(ScAddr const & variable) const
+  {
+    return data->columnIndices.find(variable) != data->columnIndices.cend();
+  }
+
+  /// @returns index of the variable column or `npos` if the table does not have such variable
+  size_t getColumnIndex(ScAddr const & variable) const;
+
+  size_t getColumnsAmount() const
+  {
+    return data->variables.size();
+  }
+
+  size_t getRowsAmount() const
+  {
+    // decoding of compressed rows does not change their amount
+    if (data->rowGroups.empty())
+      return data->rowsAmount;
+    expandCopy();
+    return data->expandedRowsAmount;
+  }
+
+  /// @returns true if the table has no rows, the table is not expanded to check it
+  bool empty() const
+  {
+    return data->rowsAmount == 0;
+  }
+
+  /// @returns true if some rows have unbound columns and the table is not expanded yet
+  bool hasUnboundColumns() const
+  {
+    return !data->rowGroups.empty();
+  }
+
+  /**
+   * @brief Replace rows with unbound columns by all rows they stand for and remove duplicate rows, decode compressed
+   * rows. Rows of the table are expanded to its own rows, so its copies keep compact rows
+   */
+  void expand();
+
+  /**
+   * @brief Encode each column by the dictionary of its distinct values if codes and dictionaries take less memory
+   * than values, rows with unbound columns are expanded before it
+   */
+  void compress();
+
+  /// @returns true if columns are encoded by dictionaries and rows are not decoded yet
+  bool isCompressed() const
+  {
+    return !data->dictionaryColumns.empty();
+  }
+
+  /// @returns codes and dictionary of the column of compressed table
+  DictionaryColumn const & getDictionaryColumn(size_t column) const
+  {
+    return data->dictionaryColumns[column];
+  }
+
+  /// @returns amount of bytes taken by values of rows or by codes and dictionaries of compressed table
+  size_t getMemorySize() const;
+
+  /// Append all rows of the `source` table without expanding them
+  void addRows(
+      ReplacementsTable const & source,
+      std::vector<size_t> const & sourceColumns,
+      UnboundColumns const & unboundColumns);
+
+  /**
+   * @brief Append rows of the `source` table without expanding them
+   * @param sourceRows ascending indices of appended rows of the `source`
+   * @param sourceColumns indices of columns of this table for each column of the `source`
+   * @param unboundColumns columns of this table absent in the `source`, they become unbound in appended rows
+   */
+  void addRows(
+      ReplacementsTable const & source,
+      std::vector<size_t> const & sourceRows,
+      std::vector<size_t> const & sourceColumns,
+      UnboundColumns const & unboundColumns);
+
+  void reserve(size_t otherRowsAmount);
+
+  /// Append row with all values equal to empty ScAddr and return pointer to its values to fill them
+  ScAddr * addRow();
+
+  void addRow(Row const & row);
+
+  void addRow(ScAddrVector const & row);
+
+  /// Overwrite values of the row `to` with values of the row `from`
+  void copyRow(size_t from, size_t to);
+
+  /// Remove all rows starting from the row `otherRowsAmount`
+  void truncate(size_t otherRowsAmount);
+
+  /// Remove duplicate rows in one pass, unique rows keep their order
+  void removeDuplicateRows();
+
+  ScAddr const & get(size_t row, size_t column) const
+  {
+    return getValues()[row * data->variables.size() + column];
+  }
+
+  Row getRow(size_t row) const
+  {
+    return {getValues().data() + row * data->variables.size(), data->variables.size()};
+  }
+
+  Row operator[](size_t row) const
+  {
+    return getRow(row);
+  }
+
+  /// @throws std::out_of_range if the table does not have such variable
+  Column at(ScAddr const & variable) const;
+
+  RowIterator begin() const
+  {
+    return {this, 0};
+  }
+
+  RowIterator end() const
+  {
+    return {this, getRowsAmount()};
+  }
+
+  /// @returns projection on given variables, variables absent in the table are skipped
+  Projection project(ScAddrVector const & otherVariables) const;
+
+  /// @returns projection on all table variables except given ones
+  Projection projectWithout(ScAddrHashSet const & variablesToExclude) const;
+
+private:
+  /// Rows and column indices are allocated from the inference arena current when the data is created, rows are
+  /// accounted in its memory budget
+  struct Data
+  {
+    Data(std::pmr::memory_resource * memoryResource, std::pmr::memory_resource * rowsMemoryResource);
+
+    Data(
+        Data const & other,
+        std::pmr::memory_resource * memoryResource,
+        std::pmr::memory_resource * rowsMemoryResource);
+
+    ScAddrVector variables;
+    std::pmr::unordered_map<ScAddr, size_t, ScAddrHashFunc<uint32_t>> columnIndices;
+    std::pmr::vector<ScAddr> values;
+    size_t rowsAmount = 0;
+    std::vector<RowGroup> rowGroups;
+    std::vector<DictionaryColumn> dictionaryColumns;
+
+    /// Rows with unbound columns expanded and compressed rows decoded for const accessors of all copies of the table
+    std::pmr::vector<ScAddr> expandedValues;
+    size_t expandedRowsAmount = 0;
+    std::atomic<bool> isExpanded{false};
+    std::mutex expansionMutex;
+  };
+
+  // rows are not changed while they are shared by copies of the table, tables detach them before changing
+  std::shared_ptr<Data> data;
+
+  static std::shared_ptr<Data> const & getEmptyData();
+
+  static std::shared_ptr<Data> createData(
+      std::pmr::memory_resource * memoryResource,
+      std::pmr::memory_resource * rowsMemoryResource);
+
+  /// Copy rows of the table before changing them if they are shared with other copies of the table
+  void detach();
+
+  void addVariable(ScAddr const & variable);
+
+  void expandIfUnbound()
+  {
+    if (!data->rowGroups.empty() || !data->dictionaryColumns.empty())
+      expand();
+  }
+
+  /// @returns values of rows, rows with unbound columns and compressed rows are read from their expanded copy
+  std::pmr::vector<ScAddr> const & getValues() const
+  {
+    if (data->rowGroups.empty() && data->dictionaryColumns.empty())
+      return data->values;
+    expandCopy();
+    return data->expandedValues;
+  }
+
+  /// Expand rows to the copy kept with them if it is not done yet, threads reading shared rows wait for one another
+  void expandCopy() const;
+
+  /// Append rows projected on the given columns to the `result`, expanding only unbound columns among them
+  void expandRows(std::vector<size_t> const & columns, ReplacementsTable & result) const;
+};
+
+using Replacements = ReplacementsTable;
+}  // namespace inference
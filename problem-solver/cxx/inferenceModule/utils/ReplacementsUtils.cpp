@@ -5,377 +5,718 @@
  */
 
 #include "ReplacementsUtils.hpp"
+#include "InferenceArena.hpp"
+#include "ReplacementsBloomFilter.hpp"
+#include "ReplacementsCodeIndex.hpp"
+#include "ReplacementsGenericJoin.hpp"
+#include "ReplacementsHashIndex.hpp"
+#include "ReplacementsRowSet.hpp"
+#include "TemplateParamsCursor.hpp"
+#include "ThreadPool.hpp"
 #include "sc-memory/kpm/sc_agent.hpp"
 
+#include <algorithm>
+#include <numeric>
+
 namespace inference
 {
+namespace
+{
+std::vector<size_t> getFirstColumns(CommonColumns const & commonColumns)
+{
+  std::vector<size_t> columns;
+  columns.reserve(commonColumns.size());
+  for (auto const & commonColumn : commonColumns)
+    columns.push_back(commonColumn.first);
+  return columns;
+}
+
+std::vector<size_t> getSecondColumns(CommonColumns const & commonColumns)
+{
+  std::vector<size_t> columns;
+  columns.reserve(commonColumns.size());
+  for (auto const & commonColumn : commonColumns)
+    columns.push_back(commonColumn.second);
+  return columns;
+}
+
+/// @returns columns of the `from` replacements that are not present in the `other` replacements
+std::vector<size_t> getExclusiveColumns(Replacements const & from, Replacements const & other)
+{
+  std::vector<size_t> columns;
+  for (size_t column = 0; column < from.getColumnsAmount(); ++column)
+  {
+    if (!other.hasVariable(from.getVariables()[column]))
+      columns.push_back(column);
+  }
+  return columns;
+}
 
-Replacements ReplacementsUtils::intersectReplacements(
+/// @returns replacements without rows for variables of the `first` followed by variables exclusive to the `second`
+Replacements createJoinResult(
     Replacements const & first,
-    Replacements const & second)
+    Replacements const & second,
+    std::vector<size_t> const & secondExclusiveColumns)
+{
+  ScAddrVector resultVariables = first.getVariables();
+  for (size_t const column : secondExclusiveColumns)
+    resultVariables.push_back(second.getVariables()[column]);
+  return Replacements(resultVariables);
+}
+
+/// @returns temporary replacements with decoded rows, the given replacements keep their codes for other joins
+Replacements getDecoded(Replacements const & replacements)
 {
-  Replacements result;
-  std::vector<std::pair<size_t, size_t>> firstSecondPairs;
-  ScAddrHashSet firstKeys;
-  getKeySet(first, firstKeys);
-  ScAddrHashSet secondKeys;
-  getKeySet(second, secondKeys);
-  size_t firstAmountOfColumns = getColumnsAmount(first);
-  size_t secondAmountOfColumns = getColumnsAmount(second);
-
-  if (firstAmountOfColumns == 0)
-    return copyReplacements(second);
-  if (secondAmountOfColumns == 0)
-    return copyReplacements(first);
-
-  ScAddrHashSet commonKeysSet = getCommonKeys(firstKeys, secondKeys);
-
-  ReplacementsHashes firstHashes = calculateHashesForCommonKeys(first, commonKeysSet);
-  ReplacementsHashes secondHashes = calculateHashesForCommonKeys(second, commonKeysSet);
-  for (auto const & firstHashPair : firstHashes)
+  Replacements decoded = replacements;
+  decoded.expand();
+  return decoded;
+}
+
+void addIntersectionRow(
+    Replacements & result,
+    Replacements const & first,
+    size_t firstRow,
+    Replacements const & second,
+    size_t secondRow,
+    std::vector<size_t> const & secondExclusiveColumns)
+{
+  ScAddr * row = result.addRow();
+  Replacements::Row const & firstValues = first.getRow(firstRow);
+  row = std::copy(firstValues.begin(), firstValues.end(), row);
+  for (size_t const column : secondExclusiveColumns)
+    *row++ = second.get(secondRow, column);
+}
+
+/// @returns unique rows of the replacements projected on the given columns
+std::shared_ptr<Replacements const> getUniqueValues(
+    Replacements const & replacements,
+    std::vector<size_t> const & columns)
+{
+  ScAddrVector variables;
+  variables.reserve(columns.size());
+  for (size_t const column : columns)
+    variables.push_back(replacements.getVariables()[column]);
+  auto values = std::make_shared<Replacements>(replacements.project(variables).materialize());
+  values->removeDuplicateRows();
+  return values;
+}
+
+/// Call `handleRow(row, key, hash)` for each row with its key, keys are packed and hashed by blocks of rows
+template <typename RowHandler>
+void forEachRowKey(
+    Replacements const & replacements,
+    std::vector<size_t> const & keyColumns,
+    RowHandler const & handleRow)
+{
+  size_t constexpr blockRowsAmount = 256;
+  size_t const rowsAmount = replacements.getRowsAmount();
+  ScAddrVector keys(std::min(rowsAmount, blockRowsAmount) * keyColumns.size());
+  std::vector<uint64_t> hashes(std::min(rowsAmount, blockRowsAmount));
+  for (size_t blockBegin = 0; blockBegin < rowsAmount; blockBegin += blockRowsAmount)
   {
-    auto const & secondHashPairIterator = secondHashes.find(firstHashPair.first);
-    if (secondHashPairIterator == secondHashes.cend())
-      continue;
-    for (auto const & columnIndexInFirst : firstHashPair.second)
-    {
-      for (auto const & columnIndexInSecond : secondHashPairIterator->second)
-      {
-        bool commonPartsAreIdentical = true;
-        for (ScAddr const & commonKey : commonKeysSet)
-        {
-          if (first.at(commonKey).at(columnIndexInFirst) != second.at(commonKey).at(columnIndexInSecond))
-          {
-            commonPartsAreIdentical = false;
-            break;
-          }
-        }
-        if (commonPartsAreIdentical)
-          firstSecondPairs.emplace_back(columnIndexInFirst, columnIndexInSecond);
-      }
-    }
+    size_t const blockEnd = std::min(blockBegin + blockRowsAmount, rowsAmount);
+    ReplacementsHashIndex::packKeys(replacements, blockBegin, blockEnd, keyColumns, keys.data(), hashes.data());
+    for (size_t row = blockBegin; row < blockEnd; ++row)
+      handleRow(row, keys.data() + (row - blockBegin) * keyColumns.size(), hashes[row - blockBegin]);
   }
+}
 
-  for (ScAddr const & firstKey : firstKeys)
-    result[firstKey].reserve(firstSecondPairs.size());
-  for (ScAddr const & secondKey : secondKeys)
+/// Call `handleRow(row, key)` for each row of the probing replacements of the index with its key, keys are
+/// translated by blocks of rows
+template <typename RowHandler>
+void forEachRowCode(Replacements const & probing, ReplacementsCodeIndex const & index, RowHandler const & handleRow)
+{
+  size_t constexpr blockRowsAmount = 256;
+  size_t const rowsAmount = probing.getRowsAmount();
+  std::vector<uint64_t> keys(std::min(rowsAmount, blockRowsAmount));
+  for (size_t blockBegin = 0; blockBegin < rowsAmount; blockBegin += blockRowsAmount)
   {
-    if (!commonKeysSet.count(secondKey))
-      result[secondKey].reserve(firstSecondPairs.size());
+    size_t const blockEnd = std::min(blockBegin + blockRowsAmount, rowsAmount);
+    index.getProbingKeys(blockBegin, blockEnd, keys.data());
+    for (size_t row = blockBegin; row < blockEnd; ++row)
+      handleRow(row, keys[row - blockBegin]);
   }
+}
 
-  for (auto const & firstSecondPair : firstSecondPairs)
+/// Rows of replacements split to partitions by high bits of hashes of their keys, rows with equal keys are in
+/// partitions with the same number for all replacements split the same way
+struct KeyPartitions
+{
+  explicit KeyPartitions(std::pmr::memory_resource * memoryResource)
+    : hashes(memoryResource)
+    , rows(memoryResource)
   {
-    for (ScAddr const & firstKey : firstKeys)
-      result.at(firstKey).push_back(first.at(firstKey).at(firstSecondPair.first));
-    for (ScAddr const & secondKey : secondKeys)
+  }
+
+  std::pmr::vector<uint64_t> hashes;
+  std::pmr::vector<std::pmr::vector<size_t>> rows;
+};
+
+/// @returns amount of bits of key hashes to split rows to several partitions for each thread of the pool, partitions
+/// are small enough to index them in memory when spilled rows are read back partition by partition
+size_t getPartitionBits(ThreadPool const & pool, size_t rowsAmount)
+{
+  size_t const partitionsAmount =
+      std::max(pool.getThreadsAmount() * 4, rowsAmount / ReplacementsUtils::PARTITION_MAX_ROWS_AMOUNT);
+  size_t partitionBits = 1;
+  while ((size_t(1) << partitionBits) < partitionsAmount)
+    ++partitionBits;
+  return partitionBits;
+}
+
+KeyPartitions partitionByKey(
+    Replacements const & replacements,
+    std::vector<size_t> const & keyColumns,
+    size_t partitionBits,
+    ThreadPool & pool,
+    SharedInferenceArena const & sharedArena)
+{
+  size_t constexpr blockRowsAmount = 4096;
+  size_t const rowsAmount = replacements.getRowsAmount();
+  // arrays are sized by rows, so they are allocated as rows of replacements
+  KeyPartitions partitions(InferenceArena::getRowsMemoryResource());
+  partitions.hashes.resize(rowsAmount);
+  pool.run((rowsAmount + blockRowsAmount - 1) / blockRowsAmount, [&](size_t block) {
+    SharedInferenceArena::TaskScope const taskScope(sharedArena);
+    size_t const blockBegin = block * blockRowsAmount;
+    size_t const blockEnd = std::min(blockBegin + blockRowsAmount, rowsAmount);
+    ScAddrVector keys((blockEnd - blockBegin) * keyColumns.size());
+    ReplacementsHashIndex::packKeys(
+        replacements, blockBegin, blockEnd, keyColumns, keys.data(), partitions.hashes.data() + blockBegin);
+  });
+
+  // high bits are taken, low bits choose buckets of hash indices built over partitions
+  partitions.rows.resize(size_t(1) << partitionBits);
+  for (size_t row = 0; row < rowsAmount; ++row)
+    partitions.rows[partitions.hashes[row] >> (64 - partitionBits)].push_back(row);
+  return partitions;
+}
+
+/**
+ * @brief Find rows of the `probing` replacements which keys are absent in the `indexed` replacements, partitions of
+ * rows are processed in parallel
+ * @param isUnique if true then only the first of equal rows of the `probing` replacements is found
+ * @returns flag for each row of the `probing` replacements, it is not zero if the row is found
+ */
+std::vector<char> findRowsWithoutKeyInParallel(
+    Replacements const & probing,
+    std::vector<size_t> const & probingColumns,
+    Replacements const & indexed,
+    std::vector<size_t> const & indexedColumns,
+    bool isUnique)
+{
+  ThreadPool & pool = ThreadPool::getShared();
+  // partitions and hash indices of tasks are accounted in the memory budget of the arena of this thread
+  SharedInferenceArena const sharedArena;
+  size_t const partitionBits = getPartitionBits(pool, probing.getRowsAmount() + indexed.getRowsAmount());
+  KeyPartitions const & probingPartitions = partitionByKey(probing, probingColumns, partitionBits, pool, sharedArena);
+  KeyPartitions const & indexedPartitions = partitionByKey(indexed, indexedColumns, partitionBits, pool, sharedArena);
+
+  // each row is flagged by the task of its partition only
+  std::vector<char> isFound(probing.getRowsAmount(), 0);
+  pool.run(probingPartitions.rows.size(), [&](size_t partition) {
+    SharedInferenceArena::TaskScope const taskScope(sharedArena);
+    std::pmr::vector<size_t> const & probingRows = probingPartitions.rows[partition];
+    ReplacementsHashIndex const index(indexed, indexedColumns, indexedPartitions.rows[partition]);
+    // equal rows have equal keys, so they are in the same partition
+    ReplacementsRowSet uniqueRows(probing);
+    ScAddrVector key(probingColumns.size());
+    for (size_t const probingRow : probingRows)
     {
-      if (!commonKeysSet.count(secondKey))
-        result.at(secondKey).push_back(second.at(secondKey).at(firstSecondPair.second));
+      ReplacementsHashIndex::packKey(probing, probingRow, probingColumns, key.data());
+      if (index.findFirst(key.data(), probingPartitions.hashes[probingRow]) != ReplacementsHashIndex::npos)
+        continue;
+      if (!isUnique || uniqueRows.insert(probingRow))
+        isFound[probingRow] = 1;
     }
+  });
+  return isFound;
+}
+
+/// @returns negative, zero or positive number if the first key is less, equal or greater than the second key
+int compareKeys(
+    Replacements const & first,
+    size_t firstRow,
+    std::vector<size_t> const & firstColumns,
+    Replacements const & second,
+    size_t secondRow,
+    std::vector<size_t> const & secondColumns)
+{
+  for (size_t index = 0; index < firstColumns.size(); ++index)
+  {
+    sc_addr const & firstValue = first.get(firstRow, firstColumns[index]).GetRealAddr();
+    sc_addr const & secondValue = second.get(secondRow, secondColumns[index]).GetRealAddr();
+    if (firstValue.seg != secondValue.seg)
+      return firstValue.seg < secondValue.seg ? -1 : 1;
+    if (firstValue.offset != secondValue.offset)
+      return firstValue.offset < secondValue.offset ? -1 : 1;
   }
-  removeDuplicateColumns(result);
-  return result;
+  return 0;
 }
 
-Replacements ReplacementsUtils::subtractReplacements(Replacements const & first, Replacements const & second)
+/// @returns row indices ordered by values of key columns, rows that already come in this order are not sorted
+std::vector<size_t> getRowsOrderedByKey(Replacements const & replacements, std::vector<size_t> const & keyColumns)
 {
-  Replacements result;
-  ScAddrHashSet firstKeys;
-  getKeySet(first, firstKeys);
-  ScAddrHashSet secondKeys;
-  getKeySet(second, secondKeys);
-  size_t firstAmountOfColumns = getColumnsAmount(first);
-  size_t secondAmountOfColumns = getColumnsAmount(second);
-  std::vector<size_t> firstColumns;
-  firstColumns.reserve(firstAmountOfColumns);
+  std::vector<size_t> rows(replacements.getRowsAmount());
+  std::iota(rows.begin(), rows.end(), 0);
+  auto const & isLess = [&replacements, &keyColumns](size_t firstRow, size_t secondRow) {
+    return compareKeys(replacements, firstRow, keyColumns, replacements, secondRow, keyColumns) < 0;
+  };
+  if (!std::is_sorted(rows.cbegin(), rows.cend(), isLess))
+    std::stable_sort(rows.begin(), rows.end(), isLess);
+  return rows;
+}
 
-  if (firstAmountOfColumns == 0 || secondAmountOfColumns == 0)
-    return copyReplacements(first);
+/// @returns end of the run of rows with the same key as the row at `begin`
+size_t getKeyRunEnd(
+    Replacements const & replacements,
+    std::vector<size_t> const & rows,
+    size_t begin,
+    std::vector<size_t> const & keyColumns)
+{
+  size_t end = begin + 1;
+  while (end < rows.size() &&
+         compareKeys(replacements, rows[begin], keyColumns, replacements, rows[end], keyColumns) == 0)
+    ++end;
+  return end;
+}
+}  // namespace
 
-  ScAddrHashSet commonKeysSet = getCommonKeys(firstKeys, secondKeys);
+Replacements ReplacementsUtils::intersectReplacements(Replacements const & first, Replacements const & second)
+{
+  if (first.getRowsAmount() == 0)
+    return second;
+  if (second.getRowsAmount() == 0)
+    return first;
 
-  if (commonKeysSet.empty())
-    return copyReplacements(first);
+  CommonColumns const & commonColumns = getCommonColumns(first, second);
+  std::vector<size_t> const & secondExclusiveColumns = getExclusiveColumns(second, first);
 
-  ReplacementsHashes firstHashes = calculateHashesForCommonKeys(first, commonKeysSet);
-  ReplacementsHashes secondHashes = calculateHashesForCommonKeys(second, commonKeysSet);
-  for (auto const & firstHashPair : firstHashes)
+  Replacements result = createJoinResult(first, second, secondExclusiveColumns);
+  auto const & addResultRow = [&first, &second, &secondExclusiveColumns, &result](size_t firstRow, size_t secondRow) {
+    addIntersectionRow(result, first, firstRow, second, secondRow, secondExclusiveColumns);
+  };
+
+  if (commonColumns.empty())
   {
-    auto const & secondHashPairIterator = secondHashes.find(firstHashPair.first);
-    if (secondHashPairIterator == secondHashes.cend())
-    {
-      firstColumns.insert(firstColumns.end(), firstHashPair.second.cbegin(), firstHashPair.second.cend());
-      continue;
-    }
-    for (auto const & columnIndexInFirst : firstHashPair.second)
+    result.reserve(first.getRowsAmount() * second.getRowsAmount());
+    for (size_t firstRow = 0; firstRow < first.getRowsAmount(); ++firstRow)
     {
-      bool hasPairWithSimilarValues = false;
-      for (auto const & columnIndexInSecond : secondHashPairIterator->second)
-      {
-        bool hasDifferentValuesForAnyKey = false;
-        for (ScAddr const & commonKey : commonKeysSet)
-        {
-          if (first.at(commonKey).at(columnIndexInFirst) != second.at(commonKey).at(columnIndexInSecond))
-          {
-            hasDifferentValuesForAnyKey = true;
-            break;
-          }
-        }
-        hasPairWithSimilarValues = !hasDifferentValuesForAnyKey;
-        if (hasPairWithSimilarValues)
-          break;
-      }
-      if (!hasPairWithSimilarValues)
-        firstColumns.push_back(columnIndexInFirst);
+      for (size_t secondRow = 0; secondRow < second.getRowsAmount(); ++secondRow)
+        addResultRow(firstRow, secondRow);
     }
   }
-
-  for (ScAddr const & firstKey : firstKeys)
-    result[firstKey].reserve(firstColumns.size());
-
-  for (auto const & firstColumn : firstColumns)
+  else if (first.isCompressed() && second.isCompressed())
   {
-    for (ScAddr const & firstKey : firstKeys)
-      result.at(firstKey).push_back(first.at(firstKey).at(firstColumn));
+    SC_LOG_DEBUG("Intersect replacements by hash join on dictionary codes");
+    return intersectReplacementsByCodes(first, second);
   }
-  removeDuplicateColumns(result);
-  return result;
-}
-
-Replacements ReplacementsUtils::uniteReplacements(Replacements const & first, Replacements const & second)
-{
-  Replacements result;
-  ScAddrHashSet firstKeys;
-  getKeySet(first, firstKeys);
-  ScAddrHashSet secondKeys;
-  getKeySet(second, secondKeys);
-  ScAddrHashSet commonKeysSet = getCommonKeys(firstKeys, secondKeys);
-  size_t firstAmountOfColumns = getColumnsAmount(first);
-  if (firstAmountOfColumns == 0)
-    return copyReplacements(second);
-  size_t secondAmountOfColumns = getColumnsAmount(second);
-  if (secondAmountOfColumns == 0)
-    return copyReplacements(first);
-
-  ReplacementsHashes const & firstHashes = calculateHashesForCommonKeys(first, commonKeysSet);
-  ReplacementsHashes const & secondHashes = calculateHashesForCommonKeys(second, commonKeysSet);
-  std::unordered_set<size_t> columnsFromSecondToSkip;
-
-  // insert into columnsFromSecondToSkip all column indices from second that are equal to at least one column from first
-  for (auto const & pairForFirst : firstHashes)
+  else if (isParallelJoinPreferred(first, second))
   {
-    std::vector<size_t> const & columnsFromFirst = pairForFirst.second;
-    std::vector<size_t> const & columnsFromSecond =
-        secondHashes.count(pairForFirst.first) ? secondHashes.at(pairForFirst.first) : std::vector<size_t>();
-    for (auto const & columnFromSecond : columnsFromSecond)
-    {
-      bool isColumnFromSecondIdenticalToColumnFromFirst = true;
-      for (auto const & columnFromFirst : columnsFromFirst)
+    SC_LOG_DEBUG("Intersect replacements by parallel partitioned hash join");
+    return intersectReplacementsInParallel(first, second);
+  }
+  else
+  {
+    // rows of the smaller replacements are indexed by common values and rows of the bigger ones probe the index
+    bool const isFirstIndexed = first.getRowsAmount() <= second.getRowsAmount();
+    Replacements const & indexed = isFirstIndexed ? first : second;
+    Replacements const & probing = isFirstIndexed ? second : first;
+    std::vector<size_t> const & indexedColumns =
+        isFirstIndexed ? getFirstColumns(commonColumns) : getSecondColumns(commonColumns);
+    std::vector<size_t> const & probingColumns =
+        isFirstIndexed ? getSecondColumns(commonColumns) : getFirstColumns(commonColumns);
+
+    ReplacementsHashIndex const index(indexed, indexedColumns);
+    forEachRowKey(probing, probingColumns, [&](size_t probingRow, ScAddr const * key, uint64_t hash) {
+      for (size_t indexedRow = index.findFirst(key, hash); indexedRow != ReplacementsHashIndex::npos;
+           indexedRow = index.findNext(indexedRow, key, hash))
       {
-        for (auto const & commonKey : commonKeysSet)
-        {
-          if (first.at(commonKey).at(columnFromFirst) != second.at(commonKey).at(columnFromSecond))
-            isColumnFromSecondIdenticalToColumnFromFirst = false;
-          break;
-        }
-        if (!isColumnFromSecondIdenticalToColumnFromFirst)
-          break;
+        if (isFirstIndexed)
+          addResultRow(indexedRow, probingRow);
+        else
+          addResultRow(probingRow, indexedRow);
       }
-      if (isColumnFromSecondIdenticalToColumnFromFirst)
-        columnsFromSecondToSkip.insert(columnFromSecond);
-    }
+    });
   }
+  result.removeDuplicateRows();
+  return result;
+}
 
-  // make all possible combinations for each column from first with each column from second with common keys values
-  // taken from first
-  for (auto const & pairForFirst : firstHashes)
-  {
-    std::vector<size_t> const & columnsFromFirst = pairForFirst.second;
-    for (auto const & columnFromFirst : columnsFromFirst)
+Replacements ReplacementsUtils::intersectReplacementsInParallel(Replacements const & first, Replacements const & second)
+{
+  CommonColumns const & commonColumns = getCommonColumns(first, second);
+  std::vector<size_t> const & firstColumns = getFirstColumns(commonColumns);
+  std::vector<size_t> const & secondColumns = getSecondColumns(commonColumns);
+  std::vector<size_t> const & secondExclusiveColumns = getExclusiveColumns(second, first);
+
+  ThreadPool & pool = ThreadPool::getShared();
+  // partitions, hash indices and results of tasks are accounted in the memory budget of the arena of this thread
+  SharedInferenceArena const sharedArena;
+  size_t const partitionBits = getPartitionBits(pool, first.getRowsAmount() + second.getRowsAmount());
+  KeyPartitions const & firstPartitions = partitionByKey(first, firstColumns, partitionBits, pool, sharedArena);
+  KeyPartitions const & secondPartitions = partitionByKey(second, secondColumns, partitionBits, pool, sharedArena);
+
+  // rows with equal keys are in the same partition, so partitions are joined and deduplicated independently
+  std::vector<Replacements> partitionResults(firstPartitions.rows.size());
+  pool.run(partitionResults.size(), [&](size_t partition) {
+    SharedInferenceArena::TaskScope const taskScope(sharedArena);
+    std::pmr::vector<size_t> const & firstRows = firstPartitions.rows[partition];
+    std::pmr::vector<size_t> const & secondRows = secondPartitions.rows[partition];
+    if (firstRows.empty() || secondRows.empty())
+      return;
+
+    bool const isFirstIndexed = firstRows.size() <= secondRows.size();
+    Replacements const & indexed = isFirstIndexed ? first : second;
+    Replacements const & probing = isFirstIndexed ? second : first;
+    std::pmr::vector<size_t> const & indexedRows = isFirstIndexed ? firstRows : secondRows;
+    std::pmr::vector<size_t> const & probingRows = isFirstIndexed ? secondRows : firstRows;
+    std::vector<size_t> const & probingColumns = isFirstIndexed ? secondColumns : firstColumns;
+    std::pmr::vector<uint64_t> const & probingHashes =
+        isFirstIndexed ? secondPartitions.hashes : firstPartitions.hashes;
+
+    ReplacementsHashIndex const index(indexed, isFirstIndexed ? firstColumns : secondColumns, indexedRows);
+    Replacements partitionResult = createJoinResult(first, second, secondExclusiveColumns);
+    ScAddrVector key(commonColumns.size());
+    for (size_t const probingRow : probingRows)
     {
-      for (auto const & firstKey : firstKeys)
+      ReplacementsHashIndex::packKey(probing, probingRow, probingColumns, key.data());
+      uint64_t const hash = probingHashes[probingRow];
+      for (size_t position = index.findFirst(key.data(), hash); position != ReplacementsHashIndex::npos;
+           position = index.findNext(position, key.data(), hash))
       {
-        std::vector<ScAddr> const sameValuesToInsert(
-            firstKeys.size() > commonKeysSet.size() ? secondAmountOfColumns : 1,
-            first.at(firstKey).at(columnFromFirst));
-        result[firstKey].insert(result.at(firstKey).cend(), sameValuesToInsert.cbegin(), sameValuesToInsert.cend());
-      }
-      for (auto const & secondKey : secondKeys)
-      {
-        if (!firstKeys.count(secondKey))
-          result[secondKey].insert(
-              result[secondKey].cend(), second.at(secondKey).cbegin(), second.at(secondKey).cend());
+        size_t const indexedRow = indexedRows[position];
+        addIntersectionRow(
+            partitionResult,
+            first,
+            isFirstIndexed ? indexedRow : probingRow,
+            second,
+            isFirstIndexed ? probingRow : indexedRow,
+            secondExclusiveColumns);
       }
     }
-  }
+    partitionResult.removeDuplicateRows();
+    partitionResults[partition] = std::move(partitionResult);
+  });
 
-  // make all possible combinations for each column from second with each column from first with common keys values
-  // taken from second, skipping those columns from second that have same values as at least one column from first for
-  // each common key
-  for (auto const & pairForSecond : secondHashes)
+  Replacements result = createJoinResult(first, second, secondExclusiveColumns);
+  size_t resultRowsAmount = 0;
+  for (Replacements const & partitionResult : partitionResults)
+    resultRowsAmount += partitionResult.getRowsAmount();
+  result.reserve(resultRowsAmount);
+  for (Replacements const & partitionResult : partitionResults)
   {
-    std::vector<size_t> const & columnsFromSecond = pairForSecond.second;
-    for (auto const & columnFromSecond : columnsFromSecond)
+    for (Replacements::Row const & row : partitionResult)
+      result.addRow(row);
+  }
+  return result;
+}
+
+Replacements ReplacementsUtils::intersectReplacementsByCodes(Replacements const & first, Replacements const & second)
+{
+  CommonColumns const & commonColumns = getCommonColumns(first, second);
+  bool const isFirstIndexed = first.getRowsAmount() <= second.getRowsAmount();
+  Replacements const & indexed = isFirstIndexed ? first : second;
+  Replacements const & probing = isFirstIndexed ? second : first;
+  std::vector<size_t> const & indexedColumns =
+      isFirstIndexed ? getFirstColumns(commonColumns) : getSecondColumns(commonColumns);
+  std::vector<size_t> const & probingColumns =
+      isFirstIndexed ? getSecondColumns(commonColumns) : getFirstColumns(commonColumns);
+  // codes of too many distinct values do not fit to keys, such replacements are joined by values
+  if (!first.isCompressed() || !second.isCompressed() || !ReplacementsCodeIndex::isApplicable(indexed, indexedColumns))
+    return intersectReplacements(getDecoded(first), getDecoded(second));
+
+  std::vector<size_t> const & secondExclusiveColumns = getExclusiveColumns(second, first);
+  Replacements result = createJoinResult(first, second, secondExclusiveColumns);
+  ReplacementsCodeIndex const index(indexed, indexedColumns, probing, probingColumns);
+  forEachRowCode(probing, index, [&](size_t probingRow, uint64_t key) {
+    if (key == ReplacementsCodeIndex::NO_KEY)
+      return;
+    for (size_t indexedRow = index.findFirst(key); indexedRow != ReplacementsCodeIndex::npos;
+         indexedRow = index.findNext(indexedRow, key))
     {
-      if (columnsFromSecondToSkip.count(columnFromSecond))
-        continue;
-      for (auto const & secondKey : secondKeys)
-      {
-        std::vector<ScAddr> const sameValuesToInsert(
-            secondKeys.size() > commonKeysSet.size() ? firstAmountOfColumns : 1,
-            second.at(secondKey).at(columnFromSecond));
-        result[secondKey].insert(result.at(secondKey).cend(), sameValuesToInsert.cbegin(), sameValuesToInsert.cend());
-      }
-      for (auto const & firstKey : firstKeys)
-      {
-        if (!secondKeys.count(firstKey))
-          result[firstKey].insert(result[firstKey].cend(), first.at(firstKey).cbegin(), first.at(firstKey).cend());
-      }
+      size_t const firstRow = isFirstIndexed ? indexedRow : probingRow;
+      size_t const secondRow = isFirstIndexed ? probingRow : indexedRow;
+      ScAddr * row = result.addRow();
+      for (size_t column = 0; column < first.getColumnsAmount(); ++column)
+        *row++ = first.getDictionaryColumn(column).getValue(firstRow);
+      for (size_t const column : secondExclusiveColumns)
+        *row++ = second.getDictionaryColumn(column).getValue(secondRow);
     }
-  }
-  removeDuplicateColumns(result);
+  });
+  result.removeDuplicateRows();
+  result.compress();
   return result;
 }
 
-void ReplacementsUtils::getKeySet(Replacements const & map, ScAddrHashSet & keySet)
+bool ReplacementsUtils::isParallelJoinPreferred(Replacements const & first, Replacements const & second)
 {
-  for (auto const & pair : map)
-    keySet.insert(pair.first);
+  return first.getRowsAmount() + second.getRowsAmount() >= PARALLEL_MIN_ROWS_AMOUNT &&
+         (ThreadPool::getShared().getThreadsAmount() > 1 || InferenceArena::isSpilling());
 }
 
-ScAddrHashSet ReplacementsUtils::getCommonKeys(ScAddrHashSet const & first, ScAddrHashSet const & second)
+Replacements ReplacementsUtils::intersectReplacementsBySortMerge(
+    Replacements const & first,
+    Replacements const & second)
 {
-  ScAddrHashSet result;
-  for (ScAddr const & key : first)
+  if (first.getRowsAmount() == 0)
+    return second;
+  if (second.getRowsAmount() == 0)
+    return first;
+
+  CommonColumns const & commonColumns = getCommonColumns(first, second);
+  std::vector<size_t> const & secondExclusiveColumns = getExclusiveColumns(second, first);
+  std::vector<size_t> const & firstColumns = getFirstColumns(commonColumns);
+  std::vector<size_t> const & secondColumns = getSecondColumns(commonColumns);
+  std::vector<size_t> const & firstRows = getRowsOrderedByKey(first, firstColumns);
+  std::vector<size_t> const & secondRows = getRowsOrderedByKey(second, secondColumns);
+
+  Replacements result = createJoinResult(first, second, secondExclusiveColumns);
+  size_t firstBegin = 0;
+  size_t secondBegin = 0;
+  while (firstBegin < firstRows.size() && secondBegin < secondRows.size())
   {
-    if (second.find(key) != second.end())
-      result.insert(key);
+    int const comparison =
+        compareKeys(first, firstRows[firstBegin], firstColumns, second, secondRows[secondBegin], secondColumns);
+    if (comparison < 0)
+    {
+      ++firstBegin;
+      continue;
+    }
+    if (comparison > 0)
+    {
+      ++secondBegin;
+      continue;
+    }
+    // all rows of the run with the same key in the first are combined with all rows of such run in the second
+    size_t const firstEnd = getKeyRunEnd(first, firstRows, firstBegin, firstColumns);
+    size_t const secondEnd = getKeyRunEnd(second, secondRows, secondBegin, secondColumns);
+    for (size_t firstIndex = firstBegin; firstIndex < firstEnd; ++firstIndex)
+    {
+      for (size_t secondIndex = secondBegin; secondIndex < secondEnd; ++secondIndex)
+        addIntersectionRow(
+            result, first, firstRows[firstIndex], second, secondRows[secondIndex], secondExclusiveColumns);
+    }
+    firstBegin = firstEnd;
+    secondBegin = secondEnd;
   }
+  result.removeDuplicateRows();
   return result;
 }
 
-Replacements ReplacementsUtils::copyReplacements(Replacements const & replacements)
+Replacements ReplacementsUtils::intersectReplacementsByGenericJoin(std::vector<Replacements> const & replacementsVector)
+{
+  return ReplacementsGenericJoin(replacementsVector).getResult();
+}
+
+bool ReplacementsUtils::isSortMergeIntersectionPreferred(Replacements const & first, Replacements const & second)
+{
+  size_t const smallerRowsAmount = std::min(first.getRowsAmount(), second.getRowsAmount());
+  size_t const biggerRowsAmount = std::max(first.getRowsAmount(), second.getRowsAmount());
+  return smallerRowsAmount >= SORT_MERGE_MIN_ROWS_AMOUNT &&
+         smallerRowsAmount * SORT_MERGE_MAX_SIZE_RATIO >= biggerRowsAmount;
+}
+
+/**
+ * @brief Anti-join: rows of the first without rows of the second with the same common values. Rows of the second
+ * are indexed by common values and a Bloom filter over them rejects most of rows of the first without index lookups.
+ * Rows are checked, copied and deduplicated in one pass over the first
+ */
+Replacements ReplacementsUtils::subtractReplacements(Replacements const & first, Replacements const & second)
 {
-  Replacements result;
-  for (auto const & pair : replacements)
+  if (first.empty() || second.empty())
+    return first;
+
+  CommonColumns const & commonColumns = getCommonColumns(first, second);
+  if (commonColumns.empty())
+    return first;
+
+  if (first.isCompressed() && second.isCompressed())
   {
-    ScAddr const & key = pair.first;
-    for (ScAddr const & value : replacements.at(key))
-      result[key].push_back(value);
+    SC_LOG_DEBUG("Subtract replacements by anti-join on dictionary codes");
+    return subtractReplacementsByCodes(first, second);
   }
+  if (isParallelJoinPreferred(first, second))
+  {
+    SC_LOG_DEBUG("Subtract replacements by parallel partitioned anti-join");
+    return subtractReplacementsInParallel(first, second);
+  }
+
+  ReplacementsHashIndex const secondIndex(second, getSecondColumns(commonColumns));
+  ReplacementsBloomFilter secondFilter(second.getRowsAmount());
+  for (uint64_t const hash : secondIndex.getHashes())
+    secondFilter.add(hash);
+
+  std::vector<size_t> const & firstColumns = getFirstColumns(commonColumns);
+  Replacements result(first.getVariables());
+  ReplacementsRowSet resultRows(result);
+  forEachRowKey(first, firstColumns, [&](size_t firstRow, ScAddr const * key, uint64_t hash) {
+    if (secondFilter.mayContain(hash) && secondIndex.findFirst(key, hash) != ReplacementsHashIndex::npos)
+      return;
+    result.addRow(first.getRow(firstRow));
+    if (!resultRows.insert(result.getRowsAmount() - 1))
+      result.truncate(result.getRowsAmount() - 1);
+  });
   return result;
 }
 
-/**
- * @brief The size of the all ScAddrVector of variables is the same (it is a matrix)
- * @param replacements to convert to vector<ScTemplateParams>
- * @return vector<ScTemplateParams> of converted replacements
- */
-vector<ScTemplateParams> ReplacementsUtils::getReplacementsToScTemplateParams(
-    Replacements const & replacements)
+Replacements ReplacementsUtils::subtractReplacementsInParallel(Replacements const & first, Replacements const & second)
 {
-  vector<ScTemplateParams> result;
-  ScAddrHashSet keys;
-  getKeySet(replacements, keys);
-  if (keys.empty())
-    return result;
+  CommonColumns const & commonColumns = getCommonColumns(first, second);
+  std::vector<char> const & isRemaining = findRowsWithoutKeyInParallel(
+      first, getFirstColumns(commonColumns), second, getSecondColumns(commonColumns), true);
 
-  size_t columnsAmount = replacements.begin()->second.size();
-  for (size_t columnIndex = 0; columnIndex < columnsAmount; ++columnIndex)
+  // remaining rows are added in the order of the first, as in the serial subtraction
+  Replacements result(first.getVariables());
+  for (size_t firstRow = 0; firstRow < isRemaining.size(); ++firstRow)
   {
-    ScTemplateParams params;
-    for (ScAddr const & key : keys)
-      params.Add(key, replacements.at(key).at(columnIndex));
-    result.push_back(params);
+    if (isRemaining[firstRow])
+      result.addRow(first.getRow(firstRow));
   }
   return result;
 }
 
-size_t ReplacementsUtils::getColumnsAmount(Replacements const & replacements)
+Replacements ReplacementsUtils::subtractReplacementsByCodes(Replacements const & first, Replacements const & second)
 {
-  return (replacements.empty() ? 0 : replacements.begin()->second.size());
+  CommonColumns const & commonColumns = getCommonColumns(first, second);
+  std::vector<size_t> const & secondColumns = getSecondColumns(commonColumns);
+  if (!first.isCompressed() || !second.isCompressed() || !ReplacementsCodeIndex::isApplicable(second, secondColumns))
+    return subtractReplacements(getDecoded(first), getDecoded(second));
+
+  ReplacementsCodeIndex const secondIndex(second, secondColumns, first, getFirstColumns(commonColumns));
+  Replacements result(first.getVariables());
+  ReplacementsRowSet resultRows(result);
+  forEachRowCode(first, secondIndex, [&](size_t firstRow, uint64_t key) {
+    if (key != ReplacementsCodeIndex::NO_KEY && secondIndex.findFirst(key) != ReplacementsCodeIndex::npos)
+      return;
+    ScAddr * row = result.addRow();
+    for (size_t column = 0; column < first.getColumnsAmount(); ++column)
+      row[column] = first.getDictionaryColumn(column).getValue(firstRow);
+    if (!resultRows.insert(result.getRowsAmount() - 1))
+      result.truncate(result.getRowsAmount() - 1);
+  });
+  result.compress();
+  return result;
 }
 
-void ReplacementsUtils::removeDuplicateColumns(Replacements & replacements)
+/**
+ * @brief Unite replacements without making combinations of their rows. Rows of the first stand for all combinations
+ * with rows of the second on its exclusive variables. Rows of the second with common values different from values
+ * of all rows of the first stand for all combinations with rows of the first on its exclusive variables. These
+ * variables are unbound in the result until it is expanded
+ */
+Replacements ReplacementsUtils::uniteReplacements(Replacements const & first, Replacements const & unboundSecond)
 {
-  ScAddrHashSet keys;
-  getKeySet(replacements, keys);
-  if (keys.empty())
-    return;
-  ReplacementsHashes const & replacementsHashes = calculateHashesForCommonKeys(replacements, keys);
-  std::unordered_map<ScAddr, ScAddr, ScAddrHashFunc<uint32_t>> column;
-  std::set<size_t> columnsToRemove;
-  for (auto const & replacementsHash : replacementsHashes)
+  if (first.empty())
+    return unboundSecond;
+  if (unboundSecond.empty())
+    return first;
+  // rows of the second are compared with rows of the first by common values, so they should be bound
+  Replacements second = unboundSecond;
+  second.expand();
+
+  CommonColumns const & commonColumns = getCommonColumns(first, second);
+  std::vector<size_t> const & firstExclusiveColumns = getExclusiveColumns(first, second);
+  std::vector<size_t> const & secondExclusiveColumns = getExclusiveColumns(second, first);
+
+  Replacements result = createJoinResult(first, second, secondExclusiveColumns);
+  std::vector<size_t> firstColumns(first.getColumnsAmount());
+  std::iota(firstColumns.begin(), firstColumns.end(), 0);
+  Replacements::UnboundColumns secondExclusiveValues;
+  if (!secondExclusiveColumns.empty())
   {
-    auto const & columnsForHash = replacementsHash.second;
-    if (columnsForHash.size() > 1)
-    {
-      for (size_t firstColumnIndex = 0; firstColumnIndex < columnsForHash.size(); ++firstColumnIndex)
-      {
-        if (columnsToRemove.count(firstColumnIndex))
-          continue;
-        for (auto const & key : keys)
-          column[key] = replacements.at(key).at(columnsForHash[firstColumnIndex]);
-        for (size_t comparedColumnIndex = firstColumnIndex + 1; comparedColumnIndex < columnsForHash.size();
-             ++comparedColumnIndex)
-        {
-          if (columnsToRemove.count(comparedColumnIndex))
-            continue;
-          bool columnIsUnique = false;
-          for (auto const & key : keys)
-          {
-            if (column[key] != replacements.at(key).at(columnsForHash[comparedColumnIndex]))
-            {
-              columnIsUnique = true;
-              break;
-            }
-          }
-          if (!columnIsUnique)
-            columnsToRemove.insert(columnsForHash[comparedColumnIndex]);
-        }
-      }
-    }
+    for (size_t index = 0; index < secondExclusiveColumns.size(); ++index)
+      secondExclusiveValues.columns.push_back(first.getColumnsAmount() + index);
+    secondExclusiveValues.values = getUniqueValues(second, secondExclusiveColumns);
   }
-  for (auto columnToRemove = columnsToRemove.crbegin(); columnToRemove != columnsToRemove.crend(); columnToRemove++)
+  result.addRows(first, firstColumns, secondExclusiveValues);
+
+  // without common variables each row of the second has the same common values as rows of the first
+  if (commonColumns.empty())
   {
-    for (auto const & key : keys)
+    if (!result.hasUnboundColumns())
+      result.removeDuplicateRows();
+    return result;
+  }
+
+  std::shared_ptr<Replacements const> const & firstCommonValues =
+      getUniqueValues(first, getFirstColumns(commonColumns));
+  std::vector<size_t> commonValuesColumns(commonColumns.size());
+  std::iota(commonValuesColumns.begin(), commonValuesColumns.end(), 0);
+  std::vector<size_t> const & secondCommonColumns = getSecondColumns(commonColumns);
+  std::vector<size_t> secondRows;
+  if (isParallelJoinPreferred(*firstCommonValues, second))
+  {
+    std::vector<char> const & isSecondRowAdded = findRowsWithoutKeyInParallel(
+        second, secondCommonColumns, *firstCommonValues, commonValuesColumns, false);
+    for (size_t secondRow = 0; secondRow < isSecondRowAdded.size(); ++secondRow)
     {
-      ScAddrVector & replacementValues = replacements.at(key);
-      replacementValues.erase(replacementValues.begin() + static_cast<long>(*columnToRemove));
+      if (isSecondRowAdded[secondRow])
+        secondRows.push_back(secondRow);
     }
   }
-}
+  else
+  {
+    ReplacementsHashIndex const firstCommonValuesIndex(*firstCommonValues, commonValuesColumns);
+    forEachRowKey(second, secondCommonColumns, [&](size_t secondRow, ScAddr const * key, uint64_t hash) {
+      if (firstCommonValuesIndex.findFirst(key, hash) == ReplacementsHashIndex::npos)
+        secondRows.push_back(secondRow);
+    });
+  }
 
-ReplacementsHashes ReplacementsUtils::calculateHashesForCommonKeys(
-    Replacements const & replacements,
-    ScAddrHashSet const & commonKeys)
-{
-  ReplacementsHashes replacementsHashes;
-  size_t const columnsAmount = ReplacementsUtils::getColumnsAmount(replacements);
-  size_t const commonKeysAmount = commonKeys.empty() ? 1 : commonKeys.size();
-  std::vector<size_t> primes = {7, 13, 17, 19, 31, 41, 43};
-  for (size_t columnNumber = 0; columnNumber < columnsAmount; ++columnNumber)
+  std::vector<size_t> secondColumns(second.getColumnsAmount());
+  for (auto const & commonColumn : commonColumns)
+    secondColumns[commonColumn.second] = commonColumn.first;
+  for (size_t index = 0; index < secondExclusiveColumns.size(); ++index)
+    secondColumns[secondExclusiveColumns[index]] = first.getColumnsAmount() + index;
+  Replacements::UnboundColumns firstExclusiveValues;
+  if (!firstExclusiveColumns.empty())
   {
-    int primeInd = 0;
-    size_t offsets = 0;
-    for (auto const & commonKey : commonKeys)
-      offsets += replacements.at(commonKey).at(columnNumber).GetRealAddr().offset *
-                 primes.at(primeInd++ % primes.size());
-    replacementsHashes[offsets / commonKeysAmount].push_back(columnNumber);
+    firstExclusiveValues.columns = firstExclusiveColumns;
+    firstExclusiveValues.values = getUniqueValues(first, firstExclusiveColumns);
   }
-  return replacementsHashes;
+  result.addRows(second, secondRows, secondColumns, firstExclusiveValues);
+
+  if (!result.hasUnboundColumns())
+    result.removeDuplicateRows();
+  return result;
 }
 
-Replacements ReplacementsUtils::removeRows(Replacements const & replacements, ScAddrHashSet & keysToRemove)
+void ReplacementsUtils::getKeySet(Replacements const & replacements, ScAddrHashSet & keySet)
 {
-  Replacements result;
-  for (auto const & replacement : replacements)
+  keySet.insert(replacements.getVariables().cbegin(), replacements.getVariables().cend());
+}
+
+CommonColumns ReplacementsUtils::getCommonColumns(Replacements const & first, Replacements const & second)
+{
+  CommonColumns result;
+  for (size_t firstColumn = 0; firstColumn < first.getColumnsAmount(); ++firstColumn)
   {
-    if (keysToRemove.count(replacement.first))
-      continue;
-    result[replacement.first].assign(replacement.second.cbegin(), replacement.second.cend());
+    size_t const secondColumn = second.getColumnIndex(first.getVariables()[firstColumn]);
+    if (secondColumn != Replacements::npos)
+      result.emplace_back(firstColumn, secondColumn);
   }
   return result;
 }
+
+/**
+ * @brief Each row of replacements is converted to the ScTemplateParams with values for all variables
+ * @param replacements to convert to vector<ScTemplateParams>
+ * @return vector<ScTemplateParams> of converted replacements
+ */
+vector<ScTemplateParams> ReplacementsUtils::getReplacementsToScTemplateParams(Replacements const & replacements)
+{
+  return getReplacementsToScTemplateParams(replacements.project(replacements.getVariables()));
+}
+
+vector<ScTemplateParams> ReplacementsUtils::getReplacementsToScTemplateParams(
+    Replacements::Projection const & projection)
+{
+  TemplateParamsCursor cursor(projection);
+  vector<ScTemplateParams> result;
+  result.reserve(cursor.getRowsAmount());
+  while (cursor.next())
+    result.push_back(cursor.getParams());
+  return result;
+}
 }  // namespace inference
@@ -7,33 +7,76 @@
 #pragma once
 
 #include "Types.hpp"
+#include "ReplacementsTable.hpp"
 
 #include <sc-memory/sc_addr.hpp>
 #include <sc-memory/sc_template.hpp>
 
-using ReplacementsHashes = std::unordered_map<size_t, std::vector<size_t>>;
 using namespace std;
 
 namespace inference
 {
+/// Pairs of column indices of the same variable in the first and in the second replacements
+using CommonColumns = std::vector<std::pair<size_t, size_t>>;
+
 class ReplacementsUtils
 {
 public:
+  /// Least amount of rows in both replacements to intersect them by sort-merge
+  static size_t constexpr SORT_MERGE_MIN_ROWS_AMOUNT = 4096;
+  /// Greatest ratio of sizes of replacements to intersect them by sort-merge
+  static size_t constexpr SORT_MERGE_MAX_SIZE_RATIO = 4;
+  /// Least amount of rows in both replacements to join them in parallel
+  static size_t constexpr PARALLEL_MIN_ROWS_AMOUNT = 1 << 16;
+  /// Greatest amount of rows of both replacements in one partition of a join of spilled rows
+  static size_t constexpr PARTITION_MAX_ROWS_AMOUNT = 1 << 20;
+  /// Least amount of replacements to intersect them all at once by generic join instead of pairwise
+  static size_t constexpr GENERIC_JOIN_MIN_REPLACEMENTS_AMOUNT = 3;
+  /// Least amount of rows of searched replacements to compress them
+  static size_t constexpr COMPRESSION_MIN_ROWS_AMOUNT = 1 << 14;
+
+  /// Intersect replacements by hash join: rows of the smaller replacements are indexed by common values
   static Replacements intersectReplacements(Replacements const & first, Replacements const & second);
+  /**
+   * @brief Intersect replacements by hash join in parallel: rows of both replacements are split to partitions by
+   * hashes of common values and each pair of partitions is joined by a thread of the shared thread pool
+   */
+  static Replacements intersectReplacementsInParallel(Replacements const & first, Replacements const & second);
+  /**
+   * @brief Intersect compressed replacements by hash join on dictionary codes of common columns, rows are decoded
+   * only to add them to the result and the result is compressed too
+   */
+  static Replacements intersectReplacementsByCodes(Replacements const & first, Replacements const & second);
+  /**
+   * @brief Intersect replacements by sort-merge join: rows of both replacements are ordered by common values and
+   * runs with equal values are combined. It does not build hash tables and skips sorting of already ordered rows
+   */
+  static Replacements intersectReplacementsBySortMerge(Replacements const & first, Replacements const & second);
+  /**
+   * @brief Intersect all replacements at once by worst-case optimal generic join: variables are bound one by one and
+   * each value is checked in all replacements with the variable, so no intermediate pairwise result is built
+   */
+  static Replacements intersectReplacementsByGenericJoin(std::vector<Replacements> const & replacementsVector);
+  /// @returns true if both replacements are big and of close sizes, so sort-merge is cheaper than hash join
+  static bool isSortMergeIntersectionPreferred(Replacements const & first, Replacements const & second);
   static Replacements uniteReplacements(Replacements const & first, Replacements const & second);
   static Replacements subtractReplacements(Replacements const & first, Replacements const & second);
-  static Replacements removeRows(Replacements const & replacements, ScAddrHashSet & keysToRemove);
+  /// Subtract replacements by anti-join of partitions of rows split by hashes of common values in parallel
+  static Replacements subtractReplacementsInParallel(Replacements const & first, Replacements const & second);
+  /// Subtract compressed replacements by anti-join on dictionary codes of common columns
+  static Replacements subtractReplacementsByCodes(Replacements const & first, Replacements const & second);
+  /**
+   * @brief Check if replacements are big enough to join them by partitions: in parallel if the shared thread pool has
+   * workers, or partition by partition if rows of the inference arena are spilled to files
+   */
+  static bool isParallelJoinPreferred(Replacements const & first, Replacements const & second);
   static vector<ScTemplateParams> getReplacementsToScTemplateParams(Replacements const & replacements);
-  static size_t getColumnsAmount(Replacements const & replacements);
-  static void getKeySet(Replacements const & map, ScAddrHashSet & keySet);
+  /// Create template params for rows of projected columns, use TemplateParamsCursor to create them row by row
+  static vector<ScTemplateParams> getReplacementsToScTemplateParams(Replacements::Projection const & projection);
+  static void getKeySet(Replacements const & replacements, ScAddrHashSet & keySet);
 
 private:
-  static ScAddrHashSet getCommonKeys(ScAddrHashSet const & first, ScAddrHashSet const & second);
-  static Replacements copyReplacements(Replacements const & replacements);
-  static void removeDuplicateColumns(Replacements & replacements);
-  static ReplacementsHashes calculateHashesForCommonKeys(
-      Replacements const & replacements,
-      ScAddrHashSet const & commonKeys);
+  static CommonColumns getCommonColumns(Replacements const & first, Replacements const & second);
 };
 
 }  // namespace inference
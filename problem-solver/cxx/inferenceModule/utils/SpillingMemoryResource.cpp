@@ -0,0 +1,107 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "SpillingMemoryResource.hpp"
+
+#include <cstdlib>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <sc-memory/sc_debug.hpp>
+
+namespace inference
+{
+SpillingMemoryResource::SpillingMemoryResource(size_t memoryBudget, std::pmr::memory_resource * upstream)
+  : memoryBudget(memoryBudget)
+  , upstream(upstream)
+{
+}
+
+SpillingMemoryResource::~SpillingMemoryResource()
+{
+  for (auto const & spilledBlock : spilledBlocks)
+    munmap(spilledBlock.first, spilledBlock.second);
+}
+
+std::string SpillingMemoryResource::getSpillDirectory()
+{
+  char const * directory = std::getenv("TMPDIR");
+  return directory && *directory ? directory : "/tmp";
+}
+
+void * SpillingMemoryResource::do_allocate(size_t bytes, size_t alignment)
+{
+  if (bytes < BIG_BLOCK_MIN_SIZE)
+  {
+    memorySize += bytes;
+    return upstream->allocate(bytes, alignment);
+  }
+
+  // mapped blocks are aligned to pages, so they satisfy any alignment of rows
+  if (memoryBudget != 0 && memorySize + bytes > memoryBudget)
+  {
+    void * block = mapFile(bytes);
+    if (block)
+    {
+      spilledBlocks.emplace(block, bytes);
+      spilledMemorySize += bytes;
+      ++spilledBlocksAmount;
+      return block;
+    }
+    SC_LOG_WARNING("Rows of replacements exceed memory budget and can not be spilled to " << getSpillDirectory());
+  }
+  memorySize += bytes;
+  return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void SpillingMemoryResource::do_deallocate(void * block, size_t bytes, size_t alignment)
+{
+  if (bytes < BIG_BLOCK_MIN_SIZE)
+  {
+    memorySize -= bytes;
+    upstream->deallocate(block, bytes, alignment);
+    return;
+  }
+
+  auto const & spilledBlock = spilledBlocks.find(block);
+  if (spilledBlock != spilledBlocks.cend())
+  {
+    munmap(block, spilledBlock->second);
+    spilledMemorySize -= spilledBlock->second;
+    spilledBlocks.erase(spilledBlock);
+    return;
+  }
+  memorySize -= bytes;
+  std::pmr::new_delete_resource()->deallocate(block, bytes, alignment);
+}
+
+void * SpillingMemoryResource::mapFile(size_t bytes)
+{
+  std::string const & pathTemplate = getSpillDirectory() + "/inference-rows-XXXXXX";
+  std::vector<char> path(pathTemplate.cbegin(), pathTemplate.cend());
+  path.push_back('\0');
+  int const file = mkstemp(path.data());
+  if (file < 0)
+    return nullptr;
+  // the file is removed at once and its space is freed when the block is unmapped
+  unlink(path.data());
+  void * block = nullptr;
+  if (ftruncate(file, static_cast<off_t>(bytes)) == 0)
+  {
+    block = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    if (block == MAP_FAILED)
+      block = nullptr;
+    else
+      madvise(block, bytes, MADV_SEQUENTIAL);
+  }
+  close(file);
+  return block;
+}
+
+}  // namespace inference
@@ -0,0 +1,86 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+
+namespace inference
+{
+/**
+ * @brief Memory resource for rows of replacements with a memory budget. Small blocks are taken from the upstream
+ * resource, big blocks are taken from the heap while all allocated blocks fit the budget and from temporary files
+ * mapped to memory beyond it. Pages of mapped files are written back and evicted by the kernel under memory pressure,
+ * so rows spilled to files are read back on access instead of exhausting memory of the process
+ */
+class SpillingMemoryResource : public std::pmr::memory_resource
+{
+public:
+  /// Least size of a block taken from the heap or from a file instead of the upstream resource
+  static size_t constexpr BIG_BLOCK_MIN_SIZE = 1 << 16;
+
+  /**
+   * @param memoryBudget greatest amount of bytes of blocks kept in memory, 0 for no limit
+   * @param upstream resource of small blocks
+   */
+  SpillingMemoryResource(size_t memoryBudget, std::pmr::memory_resource * upstream);
+
+  SpillingMemoryResource(SpillingMemoryResource const & other) = delete;
+
+  SpillingMemoryResource & operator=(SpillingMemoryResource const & other) = delete;
+
+  ~SpillingMemoryResource() override;
+
+  /// @returns amount of bytes of allocated blocks kept in memory
+  size_t getMemorySize() const
+  {
+    return memorySize;
+  }
+
+  /// @returns amount of bytes of allocated blocks spilled to files
+  size_t getSpilledMemorySize() const
+  {
+    return spilledMemorySize;
+  }
+
+  /// @returns amount of blocks spilled to files since the resource is created
+  size_t getSpilledBlocksAmount() const
+  {
+    return spilledBlocksAmount;
+  }
+
+  /// @returns directory of temporary files: `TMPDIR` environment variable or `/tmp`
+  static std::string getSpillDirectory();
+
+protected:
+  void * do_allocate(size_t bytes, size_t alignment) override;
+
+  void do_deallocate(void * block, size_t bytes, size_t alignment) override;
+
+  bool do_is_equal(std::pmr::memory_resource const & other) const noexcept override
+  {
+    return this == &other;
+  }
+
+private:
+  size_t memoryBudget;
+  std::pmr::memory_resource * upstream;
+  // sizes are read by other threads while blocks are allocated through a synchronized resource
+  std::atomic<size_t> memorySize{0};
+  std::atomic<size_t> spilledMemorySize{0};
+  std::atomic<size_t> spilledBlocksAmount{0};
+  /// sizes of mapped files of spilled blocks
+  std::unordered_map<void *, size_t> spilledBlocks;
+
+  /// @returns block mapped to a new unlinked temporary file or nullptr if the file is not created
+  static void * mapFile(size_t bytes);
+};
+
+}  // namespace inference
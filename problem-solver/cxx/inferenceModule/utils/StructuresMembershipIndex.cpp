@@ -0,0 +1,84 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "StructuresMembershipIndex.hpp"
+
+#include "sc-agents-common/utils/IteratorUtils.hpp"
+
+#include <algorithm>
+
+namespace inference
+{
+StructuresMembershipIndex::StructuresMembershipIndex(
+    ScMemoryContext * context,
+    ScAddrVector const & structures,
+    ScType const & elementType)
+  : context(context)
+  , structures(structures)
+  , elementType(elementType)
+{
+  auto const & onChange = [this](ScAddr const &, ScAddr const &, ScAddr const & element) {
+    std::lock_guard<std::mutex> const lock(changedElementsMutex);
+    changedElements.push_back(element);
+    return true;
+  };
+  for (ScAddr const & structure : structures)
+  {
+    events.push_back(std::make_unique<ScEventAddOutputEdge>(*context, structure, onChange));
+    events.push_back(std::make_unique<ScEventRemoveOutputEdge>(*context, structure, onChange));
+  }
+}
+
+void StructuresMembershipIndex::update()
+{
+  ScAddrVector checkedElements;
+  {
+    std::lock_guard<std::mutex> const lock(changedElementsMutex);
+    checkedElements.swap(changedElements);
+  }
+  // elements changed before the first reading are read with all elements, later changes are checked by next update
+  if (!isRead)
+  {
+    SC_LOG_DEBUG("start input structures processing");
+    for (ScAddr const & structure : structures)
+    {
+      ScAddrVector const & structureElements = utils::IteratorUtils::getAllWithType(context, structure, elementType);
+      elements.insert(structureElements.cbegin(), structureElements.cend());
+    }
+    isRead = true;
+    SC_LOG_DEBUG("input structures processed, found " << elements.size() << " elements");
+    return;
+  }
+
+  // an element may be added and removed several times or belong to other structure, so its membership is checked
+  for (ScAddr const & element : checkedElements)
+  {
+    if (isIndexed(element) && isInStructures(element))
+      elements.insert(element);
+    else
+      elements.erase(element);
+  }
+}
+
+void StructuresMembershipIndex::addElement(ScAddr const & structure, ScAddr const & element)
+{
+  if (std::find(structures.cbegin(), structures.cend(), structure) != structures.cend() && isIndexed(element))
+    elements.insert(element);
+}
+
+bool StructuresMembershipIndex::isIndexed(ScAddr const & element) const
+{
+  return elementType == ScType::Unknown || context->GetElementType(element).BitAnd(elementType) == elementType;
+}
+
+bool StructuresMembershipIndex::isInStructures(ScAddr const & element) const
+{
+  return std::any_of(structures.cbegin(), structures.cend(), [this, &element](ScAddr const & structure) {
+    return context->HelperCheckEdge(structure, element, ScType::EdgeAccessConstPosPerm);
+  });
+}
+
+}  // namespace inference
@@ -0,0 +1,72 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "sc-memory/sc_event.hpp"
+#include "sc-memory/sc_memory.hpp"
+
+#include "Types.hpp"
+
+namespace inference
+{
+/**
+ * @brief Set of elements of structures. Elements are read once and membership of elements is checked in memory instead
+ * of checking edges from each structure. The set is kept up to date by sc-events about edges added to or removed from
+ * structures, only elements of these edges are checked again
+ */
+class StructuresMembershipIndex
+{
+public:
+  /// @param elementType type of indexed elements, other elements of structures are not indexed
+  StructuresMembershipIndex(ScMemoryContext * context, ScAddrVector const & structures, ScType const & elementType);
+
+  StructuresMembershipIndex(StructuresMembershipIndex const & other) = delete;
+
+  StructuresMembershipIndex & operator=(StructuresMembershipIndex const & other) = delete;
+
+  /// Read elements of structures for the first time or check elements of edges added or removed after the last update
+  void update();
+
+  /// Add the element to the set right after it is added to the structure, before the sc-event about the edge is
+  /// processed
+  void addElement(ScAddr const & structure, ScAddr const & element);
+
+  bool contains(ScAddr const & element) const
+  {
+    return elements.count(element);
+  }
+
+  size_t getSize() const
+  {
+    return elements.size();
+  }
+
+  ScAddrVector const & getStructures() const
+  {
+    return structures;
+  }
+
+private:
+  ScMemoryContext * context;
+  ScAddrVector structures;
+  ScType elementType;
+  ScAddrHashSet elements;
+  bool isRead = false;
+  // elements of edges added or removed by other threads, they are checked by the thread using the set
+  std::mutex changedElementsMutex;
+  ScAddrVector changedElements;
+  std::vector<std::unique_ptr<ScEvent>> events;
+
+  bool isIndexed(ScAddr const & element) const;
+  bool isInStructures(ScAddr const & element) const;
+};
+
+}  // namespace inference
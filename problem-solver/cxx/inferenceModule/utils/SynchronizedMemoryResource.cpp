@@ -0,0 +1,29 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "SynchronizedMemoryResource.hpp"
+
+namespace inference
+{
+SynchronizedMemoryResource::SynchronizedMemoryResource(std::pmr::memory_resource * upstream, std::mutex & mutex)
+  : upstream(upstream)
+  , mutex(mutex)
+{
+}
+
+void * SynchronizedMemoryResource::do_allocate(size_t bytes, size_t alignment)
+{
+  std::lock_guard<std::mutex> const lock(mutex);
+  return upstream->allocate(bytes, alignment);
+}
+
+void SynchronizedMemoryResource::do_deallocate(void * block, size_t bytes, size_t alignment)
+{
+  std::lock_guard<std::mutex> const lock(mutex);
+  upstream->deallocate(block, bytes, alignment);
+}
+
+}  // namespace inference
@@ -0,0 +1,42 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <memory_resource>
+#include <mutex>
+
+namespace inference
+{
+/**
+ * @brief Memory resource which passes blocks to the upstream resource under a mutex, so threads may share an
+ * unsynchronized resource. Resources with the same upstream should lock the same mutex
+ */
+class SynchronizedMemoryResource : public std::pmr::memory_resource
+{
+public:
+  SynchronizedMemoryResource(std::pmr::memory_resource * upstream, std::mutex & mutex);
+
+  SynchronizedMemoryResource(SynchronizedMemoryResource const & other) = delete;
+
+  SynchronizedMemoryResource & operator=(SynchronizedMemoryResource const & other) = delete;
+
+protected:
+  void * do_allocate(size_t bytes, size_t alignment) override;
+
+  void do_deallocate(void * block, size_t bytes, size_t alignment) override;
+
+  bool do_is_equal(std::pmr::memory_resource const & other) const noexcept override
+  {
+    return this == &other;
+  }
+
+private:
+  std::pmr::memory_resource * upstream;
+  std::mutex & mutex;
+};
+
+}  // namespace inference
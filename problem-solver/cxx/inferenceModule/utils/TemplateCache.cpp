@@ -0,0 +1,198 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "TemplateCache.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace inference
+{
+TemplateCache::TemplateCache(ScMemoryContext * context)
+  : context(context)
+{
+}
+
+bool TemplateCache::buildTemplate(ScAddr const & formula, ScTemplateParams const & params, ScTemplate & result)
+{
+  std::lock_guard<std::mutex> const lock(mutex);
+  Formula const & cachedFormula = getReadFormula(formula);
+  if (cachedFormula.triples.empty())
+    return context->HelperBuildTemplate(result, formula, params);
+
+  auto const & makeItem = [&params](Element const & element) -> ScTemplateItemValue {
+    if (!element.type.IsVar())
+      return element.addr;
+    ScAddr value;
+    if (params.Get(element.addr, value))
+      return element.isDeclaration ? value >> element.alias : ScTemplateItemValue(value);
+    return element.isDeclaration ? element.type >> element.alias : ScTemplateItemValue(element.alias);
+  };
+  for (std::array<Element, 3> const & triple : cachedFormula.triples)
+    result.Triple(makeItem(triple[0]), makeItem(triple[1]), makeItem(triple[2]));
+  return true;
+}
+
+std::vector<std::array<ScAddr, 3>> TemplateCache::getTriples(ScAddr const & formula)
+{
+  std::lock_guard<std::mutex> const lock(mutex);
+  std::vector<std::array<ScAddr, 3>> triples;
+  for (std::array<Element, 3> const & triple : getReadFormula(formula).triples)
+    triples.push_back({triple[0].addr, triple[1].addr, triple[2].addr});
+  return triples;
+}
+
+size_t TemplateCache::getFormulasAmount() const
+{
+  std::lock_guard<std::mutex> const lock(mutex);
+  return formulas.size();
+}
+
+size_t TemplateCache::getReadsAmount() const
+{
+  std::lock_guard<std::mutex> const lock(mutex);
+  return readsAmount;
+}
+
+TemplateCache::Formula & TemplateCache::getFormula(ScAddr const & formula)
+{
+  auto const & found = formulas.find(formula);
+  if (found != formulas.cend())
+    return *found->second;
+
+  auto cachedFormula = std::make_unique<Formula>();
+  auto const & onChange = [cachedFormula = cachedFormula.get()](ScAddr const &, ScAddr const &, ScAddr const &) {
+    cachedFormula->isChanged = true;
+    return true;
+  };
+  cachedFormula->addEvent = std::make_unique<ScEventAddOutputEdge>(*context, formula, onChange);
+  cachedFormula->removeEvent = std::make_unique<ScEventRemoveOutputEdge>(*context, formula, onChange);
+  return *formulas.emplace(formula, std::move(cachedFormula)).first->second;
+}
+
+TemplateCache::Formula & TemplateCache::getReadFormula(ScAddr const & formula)
+{
+  Formula & cachedFormula = getFormula(formula);
+  if (cachedFormula.isChanged.exchange(false))
+  {
+    readTriples(formula, cachedFormula.triples);
+    ++readsAmount;
+  }
+  return cachedFormula;
+}
+
+void TemplateCache::readTriples(ScAddr const & formula, std::vector<std::array<Element, 3>> & triples) const
+{
+  triples.clear();
+  ScIterator3Ptr const & elementsIterator =
+      context->Iterator3(formula, ScType::EdgeAccessConstPosPerm, ScType::Unknown);
+  while (elementsIterator->Next())
+  {
+    ScAddr const & edge = elementsIterator->Get(2);
+    ScAddr source;
+    ScAddr target;
+    if (context->GetElementType(edge).IsEdge() && context->GetEdgeInfo(edge, source, target))
+    {
+      std::array<Element, 3> & triple = triples.emplace_back();
+      std::array<ScAddr, 3> const edgeTriple = {source, edge, target};
+      for (size_t index = 0; index < edgeTriple.size(); ++index)
+      {
+        ScAddr const & addr = edgeTriple[index];
+        triple[index] = {addr, context->GetElementType(addr), std::to_string(addr.Hash()), false};
+      }
+    }
+  }
+  orderTriples(triples);
+}
+
+void TemplateCache::orderTriples(std::vector<std::array<Element, 3>> & triples) const
+{
+  // amounts of edges of the triple edge type going from the source and coming to the target of each triple, they are
+  // counted for constants only
+  std::vector<std::array<size_t, 2>> degrees;
+  degrees.reserve(triples.size());
+  ScAddrHashSet pendingEdges;
+  for (std::array<Element, 3> const & triple : triples)
+  {
+    degrees.push_back(
+        {triple[0].type.IsVar() ? 0 : countEdges(triple[0].addr, triple[1].type, true),
+         triple[2].type.IsVar() ? 0 : countEdges(triple[2].addr, triple[1].type, false)});
+    pendingEdges.insert(triple[1].addr);
+  }
+
+  ScAddrHashSet boundElements;
+  auto const & isBound = [&boundElements](Element const & element) {
+    return !element.type.IsVar() || boundElements.count(element.addr);
+  };
+  // estimated amount of edges iterated to find the triple when elements of triples added before are found
+  auto const & getCost = [&triples, &degrees, &isBound](size_t index) -> size_t {
+    std::array<Element, 3> const & triple = triples[index];
+    bool const isSourceBound = isBound(triple[0]);
+    bool const isTargetBound = isBound(triple[2]);
+    if (!triple[1].type.IsVar() || (isSourceBound && isTargetBound))
+      return 0;
+    size_t cost = SIZE_MAX;
+    if (isSourceBound)
+      cost = triple[0].type.IsVar() ? BOUND_VARIABLE_DEGREE : degrees[index][0];
+    if (isTargetBound)
+      cost = std::min(cost, triple[2].type.IsVar() ? BOUND_VARIABLE_DEGREE : degrees[index][1]);
+    return cost;
+  };
+
+  std::vector<std::array<Element, 3>> orderedTriples;
+  orderedTriples.reserve(triples.size());
+  std::vector<bool> isAdded(triples.size(), false);
+  while (orderedTriples.size() < triples.size())
+  {
+    // a triple with an edge of the formula as source or target follows the triple of this edge, so the edge alias is
+    // declared before it is used
+    size_t bestIndex = triples.size();
+    size_t bestCost = SIZE_MAX;
+    for (size_t index = 0; index < triples.size(); ++index)
+    {
+      if (isAdded[index] || pendingEdges.count(triples[index][0].addr) || pendingEdges.count(triples[index][2].addr))
+        continue;
+      size_t const cost = getCost(index);
+      if (bestIndex == triples.size() || cost < bestCost)
+      {
+        bestIndex = index;
+        bestCost = cost;
+      }
+    }
+    // edges of a cycle refer to each other, so the first of them is added before edges it refers to
+    if (bestIndex == triples.size())
+      bestIndex = std::find(isAdded.cbegin(), isAdded.cend(), false) - isAdded.cbegin();
+
+    isAdded[bestIndex] = true;
+    pendingEdges.erase(triples[bestIndex][1].addr);
+    for (Element const & element : triples[bestIndex])
+      boundElements.insert(element.addr);
+    orderedTriples.push_back(triples[bestIndex]);
+  }
+
+  // the first item of a variable in the ordered triples declares its alias
+  ScAddrHashSet declaredElements;
+  for (std::array<Element, 3> & triple : orderedTriples)
+  {
+    for (Element & element : triple)
+      element.isDeclaration = declaredElements.insert(element.addr).second;
+  }
+  triples = std::move(orderedTriples);
+}
+
+size_t TemplateCache::countEdges(ScAddr const & element, ScType const & edgeType, bool isOutgoing) const
+{
+  ScType const & constEdgeType = edgeType.IsVar() ? edgeType.UpConstType() : edgeType;
+  ScIterator3Ptr const & edgesIterator = isOutgoing
+                                             ? context->Iterator3(element, constEdgeType, ScType::Unknown)
+                                             : context->Iterator3(ScType::Unknown, constEdgeType, element);
+  size_t amount = 0;
+  while (amount < DEGREE_COUNT_LIMIT && edgesIterator->Next())
+    ++amount;
+  return amount;
+}
+
+}  // namespace inference
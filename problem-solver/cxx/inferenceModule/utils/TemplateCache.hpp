@@ -0,0 +1,90 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sc-memory/sc_event.hpp"
+#include "sc-memory/sc_memory.hpp"
+
+#include "Types.hpp"
+
+namespace inference
+{
+/**
+ * @brief Cache of triples of formula structures. A formula is read from the knowledge base once and its templates are
+ * built from cached triples with values of variables bound by params, so building a template for each row of
+ * arguments does not walk the formula again. Cached triples of a formula are read again after elements are added to
+ * or removed from the formula.
+ * Triples are ordered once per reading of the formula, so the search starts from the triple with the least amount of
+ * edges going from or coming to its constant and continues with triples connected to elements found before. Amounts
+ * of edges of constants are counted up to a limit, so a huge class is not walked to find out that it is huge
+ */
+class TemplateCache
+{
+public:
+  explicit TemplateCache(ScMemoryContext * context);
+
+  TemplateCache(TemplateCache const & other) = delete;
+
+  TemplateCache & operator=(TemplateCache const & other) = delete;
+
+  /// Build template of the formula like HelperBuildTemplate does, variables bound by params are replaced by values
+  /// @returns false if the template is not built
+  bool buildTemplate(ScAddr const & formula, ScTemplateParams const & params, ScTemplate & result);
+
+  /// @returns triples of the formula in the order they are searched, the formula is read if it is changed
+  std::vector<std::array<ScAddr, 3>> getTriples(ScAddr const & formula);
+
+  size_t getFormulasAmount() const;
+
+  /// @returns amount of readings of triples of formulas from the knowledge base
+  size_t getReadsAmount() const;
+
+private:
+  /// Edges of a constant are counted up to the limit when triples are ordered
+  static size_t constexpr DEGREE_COUNT_LIMIT = 1024;
+  /// Estimated amount of edges of a variable found by triples added before
+  static size_t constexpr BOUND_VARIABLE_DEGREE = 1;
+
+  struct Element
+  {
+    ScAddr addr;
+    ScType type;
+    std::string alias;
+    // the first item of a variable in the template declares its alias, next items refer to the alias
+    bool isDeclaration;
+  };
+
+  struct Formula
+  {
+    std::vector<std::array<Element, 3>> triples;
+    std::atomic_bool isChanged = true;
+    std::unique_ptr<ScEventAddOutputEdge> addEvent;
+    std::unique_ptr<ScEventRemoveOutputEdge> removeEvent;
+  };
+
+  ScMemoryContext * context;
+  mutable std::mutex mutex;
+  std::unordered_map<ScAddr, std::unique_ptr<Formula>, ScAddrHashFunc<uint32_t>> formulas;
+  size_t readsAmount = 0;
+
+  Formula & getFormula(ScAddr const & formula);
+  /// @returns cached formula, its triples are read again if the formula is changed
+  Formula & getReadFormula(ScAddr const & formula);
+  void readTriples(ScAddr const & formula, std::vector<std::array<Element, 3>> & triples) const;
+  void orderTriples(std::vector<std::array<Element, 3>> & triples) const;
+  size_t countEdges(ScAddr const & element, ScType const & edgeType, bool isOutgoing) const;
+};
+
+}  // namespace inference
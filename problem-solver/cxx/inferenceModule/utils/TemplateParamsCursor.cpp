@@ -0,0 +1,36 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "TemplateParamsCursor.hpp"
+
+namespace inference
+{
+TemplateParamsCursor::TemplateParamsCursor(Replacements::Projection const & otherProjection)
+  : expandedRows(otherProjection.hasUnboundColumns() ? otherProjection.materialize() : Replacements())
+  , projection(
+        otherProjection.hasUnboundColumns() ? expandedRows.project(expandedRows.getVariables()) : otherProjection)
+{
+}
+
+TemplateParamsCursor::TemplateParamsCursor(Replacements const & replacements)
+  : TemplateParamsCursor(replacements.project(replacements.getVariables()))
+{
+}
+
+bool TemplateParamsCursor::next()
+{
+  if (row >= getRowsAmount())
+    return false;
+  // params do not allow to replace values of variables, so they are cleared before each row
+  params = ScTemplateParams();
+  ScAddrVector const & variables = projection.getVariables();
+  for (size_t column = 0; column < variables.size(); ++column)
+    params.Add(variables[column], projection.get(row, column));
+  ++row;
+  return true;
+}
+
+}  // namespace inference
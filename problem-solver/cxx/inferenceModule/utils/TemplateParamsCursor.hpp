@@ -0,0 +1,61 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <sc-memory/sc_template.hpp>
+
+#include "ReplacementsTable.hpp"
+
+namespace inference
+{
+/**
+ * @brief Cursor over rows of replacements projection which fills template params of the current row on demand, so
+ * params of all rows are never kept at once. Rows with unbound columns are expanded only by projected columns and
+ * repeated projected rows are skipped then, as a materialized projection does. The projected table should outlive
+ * the cursor
+ */
+class TemplateParamsCursor
+{
+public:
+  explicit TemplateParamsCursor(Replacements::Projection const & projection);
+
+  /// Cursor over rows of all variables of replacements
+  explicit TemplateParamsCursor(Replacements const & replacements);
+
+  TemplateParamsCursor(TemplateParamsCursor const & other) = delete;
+
+  TemplateParamsCursor & operator=(TemplateParamsCursor const & other) = delete;
+
+  /// Fill params with values of the next row, @returns false if there are no rows left
+  bool next();
+
+  /// @returns params of the current row, they are valid until the next call of `next`
+  ScTemplateParams const & getParams() const
+  {
+    return params;
+  }
+
+  /// @returns amount of rows of the cursor, it is 0 for projection without columns
+  size_t getRowsAmount() const
+  {
+    return projection.getColumnsAmount() == 0 ? 0 : projection.getRowsAmount();
+  }
+
+  /// Move the cursor before the first row
+  void reset()
+  {
+    row = 0;
+  }
+
+private:
+  Replacements expandedRows;
+  Replacements::Projection projection;
+  size_t row = 0;
+  ScTemplateParams params;
+};
+
+}  // namespace inference
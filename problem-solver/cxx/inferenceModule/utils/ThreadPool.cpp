@@ -0,0 +1,131 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace inference
+{
+struct ThreadPool::Loop
+{
+  Loop(size_t tasksAmount, std::function<void(size_t task)> const & task)
+    : tasksAmount(tasksAmount)
+    , task(task)
+  {
+  }
+
+  size_t const tasksAmount;
+  std::function<void(size_t task)> const & task;
+  std::atomic<size_t> nextTask{0};
+  std::atomic<bool> isFailed{false};
+  std::exception_ptr exception;
+  std::mutex mutex;
+  std::condition_variable finished;
+  size_t finishedTasksAmount = 0;
+
+  /// Run tasks of the loop until all of them are taken
+  void runTasks()
+  {
+    size_t taskIndex;
+    while ((taskIndex = nextTask.fetch_add(1)) < tasksAmount)
+    {
+      if (!isFailed)
+      {
+        try
+        {
+          task(taskIndex);
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!isFailed.exchange(true))
+            exception = std::current_exception();
+        }
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      if (++finishedTasksAmount == tasksAmount)
+        finished.notify_all();
+    }
+  }
+};
+
+ThreadPool::ThreadPool(size_t threadsAmount)
+{
+  for (size_t worker = 1; worker < threadsAmount; ++worker)
+    workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    isStopped = true;
+  }
+  loopAdded.notify_all();
+  for (std::thread & worker : workers)
+    worker.join();
+}
+
+ThreadPool & ThreadPool::getShared()
+{
+  static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u));
+  return pool;
+}
+
+void ThreadPool::run(size_t tasksAmount, std::function<void(size_t task)> const & task)
+{
+  if (tasksAmount == 0)
+    return;
+  if (workers.empty() || tasksAmount == 1)
+  {
+    for (size_t taskIndex = 0; taskIndex < tasksAmount; ++taskIndex)
+      task(taskIndex);
+    return;
+  }
+
+  auto const loop = std::make_shared<Loop>(tasksAmount, task);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    loops.push_back(loop);
+  }
+  loopAdded.notify_all();
+  loop->runTasks();
+
+  std::unique_lock<std::mutex> lock(loop->mutex);
+  loop->finished.wait(lock, [&loop]() {
+    return loop->finishedTasksAmount == loop->tasksAmount;
+  });
+  if (loop->exception)
+    std::rethrow_exception(loop->exception);
+}
+
+void ThreadPool::work()
+{
+  while (true)
+  {
+    std::shared_ptr<Loop> loop;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      loopAdded.wait(lock, [this]() {
+        return isStopped || !loops.empty();
+      });
+      if (isStopped)
+        return;
+      loop = loops.front();
+      // the loop is removed when all its tasks are taken, workers which take its tasks later go to the next loop
+      if (loop->nextTask >= loop->tasksAmount)
+      {
+        loops.pop_front();
+        continue;
+      }
+    }
+    loop->runTasks();
+  }
+}
+}  // namespace inference
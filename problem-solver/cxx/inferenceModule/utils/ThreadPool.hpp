@@ -0,0 +1,63 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace inference
+{
+/**
+ * @brief Pool of worker threads running numbered tasks of parallel loops. The thread that runs a loop takes its tasks
+ * too, so loops may be run from tasks of other loops. Worker threads have no inference arena, memory allocated in
+ * tasks is taken from the default memory resource
+ */
+class ThreadPool
+{
+public:
+  /// @param threadsAmount amount of threads running tasks together with the thread that runs a loop
+  explicit ThreadPool(size_t threadsAmount);
+
+  ThreadPool(ThreadPool const & other) = delete;
+
+  ThreadPool & operator=(ThreadPool const & other) = delete;
+
+  ~ThreadPool();
+
+  /// @returns pool shared by all inference runs with a thread for each hardware thread
+  static ThreadPool & getShared();
+
+  /// @returns amount of threads running tasks of a loop including the thread that runs it
+  size_t getThreadsAmount() const
+  {
+    return workers.size() + 1;
+  }
+
+  /**
+   * @brief Run tasks from 0 to `tasksAmount` in parallel and wait for all of them
+   * @throws exception thrown by a task after all started tasks are finished, the rest tasks are not run
+   */
+  void run(size_t tasksAmount, std::function<void(size_t task)> const & task);
+
+private:
+  struct Loop;
+
+  std::vector<std::thread> workers;
+  std::deque<std::shared_ptr<Loop>> loops;
+  std::mutex mutex;
+  std::condition_variable loopAdded;
+  bool isStopped = false;
+
+  void work();
+};
+}  // namespace inference